@@ -0,0 +1,217 @@
+#include "AnsiParser.hpp"
+
+#include <charconv>
+#include <cstring>
+
+namespace {
+    constexpr char ESC = '\x1b';
+    constexpr char BEL = '\x07';
+
+    // Give up on sequences that are clearly never going to terminate
+    constexpr size_t MAX_PENDING_LEN = 4096;
+
+    constexpr uint32_t Rgb(uint32_t r, uint32_t g, uint32_t b) {
+        return r | (g << 8) | (b << 16) | (0xFFu << 24);
+    }
+
+    // Reasonably readable on a dark background
+    constexpr uint32_t PALETTE_16[16] = {
+        Rgb(0x00, 0x00, 0x00), Rgb(0xcd, 0x31, 0x31), Rgb(0x0d, 0xbc, 0x79), Rgb(0xe5, 0xe5, 0x10),
+        Rgb(0x24, 0x72, 0xc8), Rgb(0xbc, 0x3f, 0xbc), Rgb(0x11, 0xa8, 0xcd), Rgb(0xe5, 0xe5, 0xe5),
+        Rgb(0x66, 0x66, 0x66), Rgb(0xf1, 0x4c, 0x4c), Rgb(0x23, 0xd1, 0x8b), Rgb(0xf5, 0xf5, 0x43),
+        Rgb(0x3b, 0x8e, 0xea), Rgb(0xd6, 0x70, 0xd6), Rgb(0x29, 0xb8, 0xdb), Rgb(0xff, 0xff, 0xff),
+    };
+
+    uint32_t Palette256(int idx) {
+        if(idx < 16) {
+            return PALETTE_16[idx];
+        }
+
+        if(idx < 232) {
+            constexpr uint32_t LEVELS[6] = {0, 95, 135, 175, 215, 255};
+
+            idx -= 16;
+            return Rgb(LEVELS[idx / 36], LEVELS[(idx / 6) % 6], LEVELS[idx % 6]);
+        }
+
+        uint32_t grey = 8 + (idx - 232) * 10;
+        return Rgb(grey, grey, grey);
+    }
+}
+
+namespace lodeb {
+    void AnsiParser::Parse(std::string_view input, std::string& text, std::vector<ColorSpan>& spans) {
+        auto push_color = [&] {
+            uint32_t color = CurrentColor();
+            uint32_t offset = static_cast<uint32_t>(text.size());
+
+            // Back to back escape sequences only need the last color
+            if(!spans.empty() && spans.back().offset == offset) {
+                spans.pop_back();
+            }
+
+            if((spans.empty() ? 0 : spans.back().color) != color) {
+                spans.push_back({offset, color});
+            }
+        };
+
+        // The color carries over from the previous input
+        if(CurrentColor() != 0) {
+            spans.push_back({static_cast<uint32_t>(text.size()), CurrentColor()});
+        }
+
+        std::string joined;
+
+        if(!pending.empty()) {
+            joined = std::move(pending) + std::string{input};
+            pending.clear();
+
+            input = joined;
+        }
+
+        size_t i = 0;
+
+        while(i < input.size()) {
+            auto* esc = static_cast<const char*>(std::memchr(input.data() + i, ESC, input.size() - i));
+            size_t esc_pos = esc ? static_cast<size_t>(esc - input.data()) : input.size();
+
+            text.append(input.substr(i, esc_pos - i));
+            i = esc_pos;
+
+            if(i >= input.size()) {
+                break;
+            }
+
+            if(i + 1 >= input.size()) {
+                pending = input.substr(i);
+                break;
+            }
+
+            char kind = input[i + 1];
+
+            if(kind == '[') {
+                // CSI: parameters then a final byte in [0x40, 0x7E]
+                size_t end = i + 2;
+
+                while(end < input.size() && !(input[end] >= 0x40 && input[end] <= 0x7E)) {
+                    end += 1;
+                }
+
+                if(end >= input.size()) {
+                    pending = input.substr(i);
+                    break;
+                }
+
+                if(input[end] == 'm') {
+                    ApplySgr(input.substr(i + 2, end - (i + 2)));
+                    push_color();
+                }
+
+                // Anything else (cursor movement, clearing, etc) is just dropped
+                i = end + 1;
+            } else if(kind == ']') {
+                // OSC: terminated by BEL or ESC '\'
+                size_t end = i + 2;
+
+                while(end < input.size() &&
+                      input[end] != BEL &&
+                      !(input[end] == ESC && end + 1 < input.size() && input[end + 1] == '\\')) {
+                    end += 1;
+                }
+
+                if(end >= input.size()) {
+                    pending = input.substr(i);
+                    break;
+                }
+
+                i = end + (input[end] == BEL ? 1 : 2);
+            } else {
+                // Two byte escape
+                i += 2;
+            }
+        }
+
+        if(pending.size() > MAX_PENDING_LEN) {
+            pending.clear();
+        }
+    }
+
+    uint32_t AnsiParser::CurrentColor() const {
+        if(has_rgb) {
+            return rgb;
+        }
+
+        if(palette_index < 0) {
+            return 0;
+        }
+
+        // Bold brightens the basic colors like most terminals do
+        return PALETTE_16[(bold && palette_index < 8) ? palette_index + 8 : palette_index];
+    }
+
+    void AnsiParser::ApplySgr(std::string_view params) {
+        int values[32];
+        int count = 0;
+
+        // Empty params are 0, so "ESC[m" is a reset
+        for(size_t start = 0; count < 32;) {
+            size_t end = params.find_first_of(";:", start);
+            auto param = params.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+
+            int value = 0;
+            std::from_chars(param.data(), param.data() + param.size(), value);
+
+            values[count++] = value;
+
+            if(end == std::string_view::npos) {
+                break;
+            }
+
+            start = end + 1;
+        }
+
+        for(int i = 0; i < count; ++i) {
+            int p = values[i];
+
+            if(p == 0) {
+                bold = false;
+                palette_index = -1;
+                has_rgb = false;
+            } else if(p == 1) {
+                bold = true;
+            } else if(p == 22) {
+                bold = false;
+            } else if(p >= 30 && p <= 37) {
+                palette_index = p - 30;
+                has_rgb = false;
+            } else if(p >= 90 && p <= 97) {
+                palette_index = p - 90 + 8;
+                has_rgb = false;
+            } else if(p == 39) {
+                palette_index = -1;
+                has_rgb = false;
+            } else if(p == 38 || p == 48 || p == 58) {
+                // Extended foreground/background/underline color, we only care about foreground
+                uint32_t color = 0;
+                bool valid = false;
+
+                if(i + 2 < count && values[i + 1] == 5) {
+                    color = Palette256(values[i + 2] & 0xFF);
+                    valid = true;
+                    i += 2;
+                } else if(i + 4 < count && values[i + 1] == 2) {
+                    color = Rgb(values[i + 2] & 0xFF, values[i + 3] & 0xFF, values[i + 4] & 0xFF);
+                    valid = true;
+                    i += 4;
+                }
+
+                if(p == 38 && valid) {
+                    has_rgb = true;
+                    rgb = color;
+                }
+            }
+
+            // Background colors, underline, italics, etc are ignored
+        }
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lodeb {
+    // A change of text color at `offset`. Colors are packed the same way as
+    // `IM_COL32` (R in the low byte) and 0 means the default text color.
+    struct ColorSpan {
+        uint32_t offset = 0;
+        uint32_t color = 0;
+    };
+
+    // Strips ANSI escape sequences out of process output, turning SGR color
+    // codes into `ColorSpan`s. Keeps its state between calls since colors and
+    // even escape sequences themselves can straddle reads.
+    //
+    // Use one per stream.
+    class AnsiParser {
+    public:
+        // Appends `input` minus any escape sequences to `text`. Color changes are
+        // appended to `spans` (offsets are into `text`). If there is a non-default
+        // color in effect, a span is always emitted at the current end of `text`.
+        void Parse(std::string_view input, std::string& text, std::vector<ColorSpan>& spans);
+
+    private:
+        // Incomplete escape sequence from the end of the last input
+        std::string pending;
+
+        bool bold = false;
+
+        // Into the 16 color palette, if set by a basic SGR code
+        int palette_index = -1;
+
+        // Set by 256 color and true color codes
+        bool has_rgb = false;
+        uint32_t rgb = 0;
+
+        uint32_t CurrentColor() const;
+
+        void ApplySgr(std::string_view params);
+    };
+}
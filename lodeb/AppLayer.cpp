@@ -5,14 +5,17 @@
 #include <imgui_stdlib.h>
 #include <tinyfiledialogs.h>
 #include <lldb/API/LLDB.h>
-#include <sstream>
 #include <unordered_set>
+#include <algorithm>
+#include <format>
 
 #include <stdio.h>
+#include <string.h>
 
 #include "ParseCommand.hpp"
 #include "Log.hpp"
 #include "LLDBUtil.hpp"
+#include "TextSearch.hpp"
 
 namespace {
     using namespace lodeb;
@@ -20,6 +23,16 @@ namespace {
     const char* COMMAND_BAR_POPUP_NAME = "Command Bar";
     const char* STATE_PATH = "lodeb.txt";
 
+    // Files bigger than this are searched on a worker so typing doesn't stall the UI
+    const size_t ASYNC_SEARCH_MIN_SIZE = 4 * 1024 * 1024;
+
+    // How much memory the memory window lets you scroll through from the address
+    const size_t MEMORY_VIEW_SIZE = 8 * 1024 * 1024;
+    const size_t MEMORY_BYTES_PER_ROW = 16;
+
+    // Values which are different from the previous stop
+    const ImVec4 CHANGED_VALUE_COLOR = {1.0, 0.45, 0.35, 1.0};
+
     bool ReadEntireFileInto(const char* path, std::string& into) {
         FILE* f = fopen(path, "rb");
 
@@ -35,6 +48,133 @@ namespace {
 
         return n == size;
     }
+
+    void IndexLines(std::string_view text, std::vector<size_t>& line_starts) {
+        line_starts.clear();
+
+        for(size_t pos = 0; pos < text.size();) {
+            line_starts.push_back(pos);
+
+            auto newline = text.find('\n', pos);
+
+            if(newline == std::string_view::npos) {
+                break;
+            }
+
+            pos = newline + 1;
+        }
+    }
+
+    // Excludes the newline
+    std::string_view GetLine(std::string_view text, const std::vector<size_t>& line_starts, size_t idx) {
+        size_t start = line_starts[idx];
+        size_t end = idx + 1 < line_starts.size() ? line_starts[idx + 1] - 1 : text.size();
+
+        if(end > start && text[end - 1] == '\n') {
+            end -= 1;
+        }
+
+        return text.substr(start, end - start);
+    }
+
+    size_t LineIndexOfOffset(const std::vector<size_t>& line_starts, size_t offset) {
+        auto found = std::upper_bound(line_starts.begin(), line_starts.end(), offset);
+        return static_cast<size_t>(found - line_starts.begin()) - 1;
+    }
+
+    bool IsCommandKeyDown(Scaffold::Input& input) {
+        using Scaffold::KeyCode;
+
+        return input.IsKeyDown(KeyCode::LeftControl) || 
+               input.IsKeyDown(KeyCode::RightControl) ||
+               input.IsKeyDown(KeyCode::LeftSuper) ||
+               input.IsKeyDown(KeyCode::RightSuper);
+    }
+
+    // Brings `search.hits` in line with `search.query`, scanning on a worker
+    // for large files.
+    void UpdateSearchHits(std::string_view text, SourceSearchState& search) {
+        if(search.pending_hits.valid()) {
+            if(search.pending_hits.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+                return;
+            }
+
+            search.hits = search.pending_hits.get();
+            search.hits_query = std::move(search.pending_query);
+            search.cur_hit = -1;
+        }
+
+        if(search.query == search.hits_query) {
+            return;
+        }
+
+        search.cur_hit = -1;
+
+        if(!search.hits_query.empty() && search.query.starts_with(search.hits_query)) {
+            // Every hit for the new query is also a hit for the old one
+            RefineHits(text, search.query, search.hits);
+            search.hits_query = search.query;
+
+            return;
+        }
+
+        if(text.size() < ASYNC_SEARCH_MIN_SIZE) {
+            search.hits.clear();
+            FindAllCaseInsensitive(text, search.query, search.hits);
+
+            search.hits_query = search.query;
+
+            return;
+        }
+
+        search.pending_query = search.query;
+
+        // NOTE(Apaar): The source text must not be modified while this is running, so
+        // we wait on this future before reloading the file.
+        search.pending_hits = std::async(std::launch::async, [text, query = search.query]() {
+            std::vector<size_t> hits;
+            FindAllCaseInsensitive(text, query, hits);
+
+            return hits;
+        });
+    }
+
+    // Jumps to the next/previous hit after the last one we jumped to (or what's on screen)
+    void JumpToSearchHit(SourceViewState& svs, bool forward) {
+        auto& search = *svs.search;
+        auto& hits = search.hits;
+
+        if(hits.empty() || svs.line_starts.empty()) {
+            return;
+        }
+
+        auto from = search.cur_hit >= 0 ?
+            hits[search.cur_hit] :
+            svs.line_starts[std::min<size_t>(svs.first_visible_line, svs.line_starts.size() - 1)];
+
+        std::vector<size_t>::iterator found;
+
+        if(forward) {
+            found = search.cur_hit >= 0 ?
+                std::upper_bound(hits.begin(), hits.end(), from) :
+                std::lower_bound(hits.begin(), hits.end(), from);
+
+            if(found == hits.end()) {
+                found = hits.begin();
+            }
+        } else {
+            found = std::lower_bound(hits.begin(), hits.end(), from);
+
+            if(found == hits.begin()) {
+                found = hits.end();
+            }
+
+            --found;
+        }
+
+        search.cur_hit = static_cast<int>(found - hits.begin());
+        svs.scroll_to_line = static_cast<int>(LineIndexOfOffset(svs.line_starts, *found)) + 1;
+    }
 }
 
 namespace lodeb {
@@ -54,7 +194,7 @@ namespace lodeb {
                 if(input.GetKeyState(KeyCode::R) == KeyState::Pressed) {
                     state.events.push_back(StartProcessEvent{});
                 }
-            } else if (ts.process_state->process.GetState() == lldb::eStateStopped) {
+            } else if (ts.process_state->IsStopped()) {
                 if(input.GetKeyState(KeyCode::R) == KeyState::Pressed) {
                     state.events.push_back(ChangeDebugStateEvent{ChangeDebugStateEvent::Kill});
                 } else if(input.GetKeyState(KeyCode::C) == KeyState::Pressed) {
@@ -72,6 +212,8 @@ namespace lodeb {
     }
 
     void AppLayer::OnRenderUI(float) {
+        frame_arena.Reset();
+
         WindowTargetSettings();
         WindowCommandBar();
         WindowSourceView();
@@ -81,6 +223,8 @@ namespace lodeb {
         WindowFrames();
         WindowWatch();
         WindowBreakpoints();
+        WindowMemory();
+        WindowWatchpoints();
     }
 
     void AppLayer::WindowTargetSettings() {
@@ -169,9 +313,6 @@ namespace lodeb {
             // via arrow up/down above.
             ImGui::BeginChild("##symbols", {400, 300}, 0, ImGuiWindowFlags_NoNav);
 
-            // ImGui doesn't handle std::string_view so we put match names in here
-            std::string name_buf;
-
             int i = 0;
 
             static int last_focused_item_index = 0;
@@ -179,7 +320,8 @@ namespace lodeb {
             ts.sym_loc_cache->ForEachMatch(sym_search->text, [&](const auto& match) {
                 ImGui::PushID(i);
 
-                name_buf = match.name;
+                // ImGui doesn't handle std::string_view so we copy match names into the arena
+                const char* name = frame_arena.Copy(match.name);
 
                 if(cmd_state.focused_item_index == -1) {
                     cmd_state.focused_item_index = i;
@@ -187,7 +329,7 @@ namespace lodeb {
 
                 bool is_focused = i == cmd_state.focused_item_index;
 
-                if(ImGui::Selectable(name_buf.c_str(), is_focused) || (is_focused && input.GetKeyState(KeyCode::Enter) == KeyState::Pressed)) {
+                if(ImGui::Selectable(name, is_focused) || (is_focused && input.GetKeyState(KeyCode::Enter) == KeyState::Pressed)) {
                     ViewSourceEvent event{to_owned(*match.loc)};
 
                     state.events.push_back(std::move(event));
@@ -214,11 +356,7 @@ namespace lodeb {
 
         auto& input = Application::GetInput();
 
-        if(input.GetKeyState(KeyCode::P) == KeyState::Pressed &&
-           (input.IsKeyDown(KeyCode::LeftControl) || 
-            input.IsKeyDown(KeyCode::RightControl) ||
-            input.IsKeyDown(KeyCode::LeftSuper) ||
-            input.IsKeyDown(KeyCode::RightSuper))) {
+        if(input.GetKeyState(KeyCode::P) == KeyState::Pressed && IsCommandKeyDown(input)) {
             ImGui::CloseCurrentPopup();
             ImGui::OpenPopup(COMMAND_BAR_POPUP_NAME);
         }
@@ -271,7 +409,18 @@ namespace lodeb {
             auto last_mod_time = std::filesystem::last_write_time(source_view_state->path, ec_ignore);
 
             if(source_view_state->last_modified_at < last_mod_time) {
+                if(source_view_state->search) {
+                    // Make sure no search is reading the text while we replace it,
+                    // and force a rescan afterwards.
+                    source_view_state->search->pending_hits = {};
+                    source_view_state->search->pending_query.clear();
+                    source_view_state->search->hits.clear();
+                    source_view_state->search->hits_query.clear();
+                }
+
                 ReadEntireFileInto(source_view_state->path.c_str(), source_view_state->text);            
+                IndexLines(source_view_state->text, source_view_state->line_starts);
+
                 LogInfo("Loaded file {}", source_view_state->path);
 
                 source_view_state->last_modified_at = last_mod_time;                
@@ -282,82 +431,256 @@ namespace lodeb {
 
         ImGui::TextUnformatted(source_view_state->path.c_str());
 
-        ImGui::BeginChild("##text", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_NoNav);;
+        std::string_view text = source_view_state->text;
 
-        std::string line_buf;
+        auto& input = Application::GetInput();
 
-        std::istringstream ss{source_view_state->text};
+        if(ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) &&
+           input.GetKeyState(KeyCode::F) == KeyState::Pressed && IsCommandKeyDown(input)) {
+            if(!source_view_state->search) {
+                source_view_state->search.emplace();
+            }
 
-        FileLoc loc = {
-            .path = source_view_state->path,
-            .line = 0,
-        };
+            source_view_state->search->focus_input = true;
+        }
 
-        for(std::string line; (loc.line += 1), std::getline(ss, line);) {
-            ImGui::PushID(loc.line);
+        if(source_view_state->search) {
+            auto& search = *source_view_state->search;
 
-            line_buf.clear();
-            std::format_to(std::back_inserter(line_buf), "{:5} {}", loc.line, line);
+            if(search.focus_input) {
+                ImGui::SetKeyboardFocusHere();
+                search.focus_input = false;
+            }
 
-            if(ImGui::InvisibleButton("##gutter", {20, 20})) {
-                state.events.push_back(ToggleBreakpointEvent{loc});
+            ImGui::SetNextItemWidth(300.0f);
+
+            bool submitted = ImGui::InputText("##find", &search.query, ImGuiInputTextFlags_EnterReturnsTrue);
+            // Escape deactivates the input in the same frame so we check for that too
+            bool close = (ImGui::IsItemActive() || ImGui::IsItemDeactivated()) &&
+                         input.GetKeyState(KeyCode::Escape) == KeyState::Pressed;
+
+            UpdateSearchHits(text, search);
+
+            bool shift_down = input.IsKeyDown(KeyCode::LeftShift) || input.IsKeyDown(KeyCode::RightShift);
+
+            if(submitted) {
+                JumpToSearchHit(*source_view_state, !shift_down);
+
+                // Enter deactivates the input but we want to keep typing/hitting enter
+                search.focus_input = true;
             }
 
             ImGui::SameLine();
 
-            auto bp = ([&]() -> std::optional<lldb::SBBreakpoint> {
-                if(!state.target_state) {
-                    return std::nullopt;
-                }
-                
-                auto found = state.target_state->loc_to_breakpoint.find(loc);
+            if(search.pending_hits.valid()) {
+                ImGui::TextUnformatted("Searching...");
+            } else if(search.cur_hit >= 0) {
+                ImGui::Text("%d/%zu", search.cur_hit + 1, search.hits.size());
+            } else {
+                ImGui::Text("%zu matches", search.hits.size());
+            }
+
+            ImGui::SameLine();
+
+            if(ImGui::Button("Prev")) {
+                JumpToSearchHit(*source_view_state, false);
+            }
+
+            ImGui::SameLine();
+
+            if(ImGui::Button("Next")) {
+                JumpToSearchHit(*source_view_state, true);
+            }
+
+            ImGui::SameLine();
+
+            if(ImGui::Button("Close") || close) {
+                source_view_state->search.reset();
+            }
+        }
+
+        // Hits are only highlighted once they match what's been typed
+        const SourceSearchState* search = source_view_state->search &&
+            !source_view_state->search->hits_query.empty() ?
+            &*source_view_state->search :
+            nullptr;
+
+        ImGui::BeginChild("##text", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_NoNav);
+
+        // Look up the file once so that each line only needs a search by line number
+        const BreakpointLineIndex::FileEntries* bp_entries = state.target_state ?
+            state.target_state->bp_line_index.FindFile(source_view_state->path) :
+            nullptr;
+
+        // Null while these are being computed (or if there's no target)
+        const BreakableLineCache::Lines* breakable_lines = state.target_state ?
+            state.target_state->breakable_lines.Find(state.target_state->target, source_view_state->path) :
+            nullptr;
+
+        // If none of the target's modules have code in this file (e.g. it's in a library which
+        // hasn't been loaded yet) we just let LLDB try to resolve the breakpoint.
+        if(breakable_lines && breakable_lines->empty()) {
+            breakable_lines = nullptr;
+        }
+
+        int cur_frame_line = (cur_frame_loc && cur_frame_loc->path == source_view_state->path) ?
+            cur_frame_loc->line :
+            -1;
+
+        // Inline values only make sense for the file we're stopped in
+        InlineValueCache* inline_values = nullptr;
+
+        if(cur_frame_line >= 0) {
+            auto& ps = *state.target_state->process_state;
+            auto frame = ps.process.GetSelectedThread().GetSelectedFrame();
+
+            inline_values = &source_view_state->inline_values;
+            inline_values->Sync(ps.process, frame);
+        }
+
+        // Every row is the same height (the gutter button is the tallest thing)
+        float row_height = std::max(20.0f, ImGui::GetTextLineHeight()) + ImGui::GetStyle().ItemSpacing.y;
+
+        if(source_view_state->scroll_to_line) {
+            float line_y = ImGui::GetCursorPosY() + (*source_view_state->scroll_to_line - 1) * row_height;
+            ImGui::SetScrollFromPosY(line_y - ImGui::GetScrollY() + row_height * 0.5f);
+        }
+
+        auto& line_starts = source_view_state->line_starts;
+
+        source_view_state->first_visible_line = static_cast<int>(ImGui::GetScrollY() / row_height);
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(line_starts.size()), row_height);
+
+        while(clipper.Step()) {
+            for(int line_idx = clipper.DisplayStart; line_idx < clipper.DisplayEnd; ++line_idx) {
+                auto line = GetLine(text, line_starts, line_idx);
+                int line_num = line_idx + 1;
+
+                ImGui::PushID(line_num);
 
-                if(found == state.target_state->loc_to_breakpoint.end()) {
-                    return std::nullopt;
+                auto* bp = bp_entries ? BreakpointLineIndex::FindLine(*bp_entries, line_num) : nullptr;
+
+                if(ImGui::InvisibleButton("##gutter", {20, 20})) {
+                    std::optional<int> toggle_line;
+
+                    if(bp) {
+                        // If a breakpoint was resolved to this line, we need to toggle the one
+                        // that was originally requested in order to remove it. All of the ones
+                        // on this line go at once.
+                        for(int requested_line : bp->requested_lines) {
+                            state.events.push_back(ToggleBreakpointEvent{{
+                                .path = source_view_state->path,
+                                .line = requested_line,
+                            }});
+                        }
+                    } else if(!breakable_lines) {
+                        toggle_line = line_num;
+                    } else {
+                        // Snap to the next line with code like LLDB would, but don't toggle
+                        // off a breakpoint that's already there.
+                        auto snapped_line = BreakableLineCache::SnapToBreakable(*breakable_lines, line_num);
+
+                        if(snapped_line && !(bp_entries && BreakpointLineIndex::FindLine(*bp_entries, *snapped_line))) {
+                            toggle_line = snapped_line;
+                        }
+                    }
+
+                    if(toggle_line) {
+                        state.events.push_back(ToggleBreakpointEvent{{
+                            .path = source_view_state->path,
+                            .line = *toggle_line,
+                        }});
+                    }
                 }
 
-                return found->second;
-            })();
+                ImGui::SameLine();
 
-            if(bp) {
                 auto* draw_list = ImGui::GetWindowDrawList();
                 auto pos = ImGui::GetItemRectMin();
 
-                if(bp->GetNumLocations() == 0) {
-                    draw_list->AddCircle(
-                        {pos.x + 10, pos.y + 10},
-                        5,
-                        ImGui::GetColorU32(ImVec4{1.0, 0.0, 0.0, 1.0})
-                    );
-                } else {
+                if(!bp && breakable_lines && std::binary_search(breakable_lines->begin(), breakable_lines->end(), line_num)) {
+                    // Mark lines that a breakpoint can actually be placed on
                     draw_list->AddCircleFilled(
                         {pos.x + 10, pos.y + 10},
-                        5,
-                        ImGui::GetColorU32(ImVec4{1.0, 0.0, 0.0, 1.0})
+                        2,
+                        ImGui::GetColorU32(ImVec4{0.5, 0.5, 0.5, 0.5})
                     );
                 }
 
-                ImGui::SameLine();
-            }
+                if(bp) {
+                    if(!bp->resolved) {
+                        draw_list->AddCircle(
+                            {pos.x + 10, pos.y + 10},
+                            5,
+                            ImGui::GetColorU32(ImVec4{1.0, 0.0, 0.0, 1.0})
+                        );
+                    } else {
+                        draw_list->AddCircleFilled(
+                            {pos.x + 10, pos.y + 10},
+                            5,
+                            ImGui::GetColorU32(ImVec4{1.0, 0.0, 0.0, 1.0})
+                        );
+                    }
 
-            bool highlight = cur_frame_loc == loc;
+                    ImGui::SameLine();
+                }
 
-            if(highlight) {
-                ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetColorU32(ImVec4{0.25, 0.5, 1.0, 1.0}));
-            }
+                bool highlight = cur_frame_line == line_num;
 
+                if(highlight) {
+                    ImGui::PushStyleColor(ImGuiCol_Text, ImGui::GetColorU32(ImVec4{0.25, 0.5, 1.0, 1.0}));
+                }
 
-            ImGui::TextUnformatted(line_buf.c_str());
 
-            if(highlight) {
-                ImGui::PopStyleColor();
-            }
+                const char* line_text = frame_arena.Format("{:5} {}", line_num, line);
 
-            if(source_view_state->scroll_to_line == loc.line) {
-                ImGui::SetScrollHereY();
-            }
+                ImGui::TextUnformatted(line_text);
 
-            ImGui::PopID();
+                if(highlight) {
+                    ImGui::PopStyleColor();
+                }
+
+                if(search) {
+                    size_t line_start = line_starts[line_idx];
+                    size_t prefix_len = strlen(line_text) - line.size();
+
+                    auto text_pos = ImGui::GetItemRectMin();
+                    float text_height = ImGui::GetItemRectSize().y;
+
+                    auto& hits = search->hits;
+
+                    for(auto hit = std::lower_bound(hits.begin(), hits.end(), line_start);
+                        hit != hits.end() && *hit < line_start + line.size();
+                        ++hit) {
+                        size_t col = *hit - line_start;
+                        size_t hit_end = std::min(col + search->hits_query.size(), line.size());
+
+                        float x0 = ImGui::CalcTextSize(line_text, line_text + prefix_len + col).x;
+                        float x1 = ImGui::CalcTextSize(line_text, line_text + prefix_len + hit_end).x;
+
+                        bool is_cur = search->cur_hit >= 0 && hits[search->cur_hit] == *hit;
+
+                        draw_list->AddRectFilled(
+                            {text_pos.x + x0, text_pos.y},
+                            {text_pos.x + x1, text_pos.y + text_height},
+                            ImGui::GetColorU32(is_cur ? ImVec4{1.0, 0.6, 0.0, 0.5} : ImVec4{1.0, 1.0, 0.0, 0.25})
+                        );
+                    }
+                }
+
+                if(inline_values) {
+                    auto& annotation = inline_values->ForLine(line_num, line);
+
+                    if(!annotation.empty()) {
+                        ImGui::SameLine(0, 20);
+                        ImGui::TextDisabled("%s", annotation.c_str());
+                    }
+                }
+
+                ImGui::PopID();
+            }
         }
 
         source_view_state->scroll_to_line.reset();
@@ -370,11 +693,193 @@ namespace lodeb {
     void AppLayer::WindowProcessOutput() {
         ImGui::Begin("Process Output");
 
-        ImGui::BeginChild("##text", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
+        auto& output = state.process_output;
+
+        int max_mb = static_cast<int>(output.MaxBytes() / (1024 * 1024));
+
+        ImGui::SetNextItemWidth(100.0f);
 
-        ImGui::TextUnformatted(state.process_output.c_str());
+        if(ImGui::InputInt("Max MB", &max_mb, 0) && max_mb > 0) {
+            output.SetMaxBytes(static_cast<size_t>(max_mb) * 1024 * 1024);
+        }
+
+        ImGui::SameLine();
+
+        // These take effect on the next launch
+        ImGui::Checkbox("Spill to disk", &state.spill_process_output);
+
+        ImGui::SameLine();
+        ImGui::Checkbox("Use pty", &state.launch_in_pty);
+
+        auto& log = state.process_output_log;
+
+        if(log.IsOpen()) {
+            ImGui::SameLine();
+
+            if(ImGui::Button("Export...")) {
+                const char* path = tinyfd_saveFileDialog("Export Process Output", "output.log", 0, nullptr, nullptr);
+
+                if(path) {
+                    log.Export(path);
+                }
+            }
+        }
+
+        // If we spilled to disk, lines which were dropped from memory are read back from the log
+        size_t first_line = state.FirstOutputLine();
+        size_t line_count = state.OutputLineCount();
+
+        if(first_line > 0) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%zu earlier lines dropped)", first_line);
+        }
+
+        auto& view_state = state.process_output_view_state;
+        auto& filter = state.process_output_filter;
+
+        ImGui::SetNextItemWidth(300.0f);
+
+        bool filter_changed = ImGui::InputTextWithHint("##filter", "Filter", &view_state.filter_text);
+
+        ImGui::SameLine();
+
+        filter_changed |= ImGui::Checkbox("Regex", &view_state.filter_regex);
+
+        if(filter_changed) {
+            view_state.filter_invalid = !filter.SetPattern(
+                view_state.filter_text,
+                view_state.filter_regex ? OutputFilter::Mode::Regex : OutputFilter::Mode::Substring
+            );
+        }
+
+        if(view_state.filter_invalid) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4{1.0, 0.3, 0.3, 1.0}, "Invalid regex");
+        } else if(filter.IsActive()) {
+            ImGui::SameLine();
+            ImGui::TextDisabled("%zu matches%s", filter.Matches().size(), filter.IsScanning() ? " (scanning...)" : "");
+        }
+
+        bool has_process = state.target_state && state.target_state->process_state;
+
+        if(has_process) {
+            auto& metrics = state.process_output_metrics;
+
+            ImGui::TextDisabled(
+                "%.1f KB/s, %.0f lines/s, backlog %zu (max %zu), max delay %.1f ms",
+                metrics.BytesPerSec() / 1024,
+                metrics.LinesPerSec(),
+                metrics.Backlog(),
+                metrics.MaxBacklog(),
+                std::chrono::duration<double, std::milli>(metrics.MaxDelay()).count()
+            );
+        }
+
+        // Leave room for the stdin line
+        float text_height = has_process ? -ImGui::GetFrameHeightWithSpacing() : -1;
+
+        ImGui::BeginChild("##text", {-1, text_height}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
+
+        // Keep following the output if we were already at the bottom
+        bool at_bottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+
+        auto render_line = [&](size_t line_num) {
+            auto line = state.OutputLine(line_num);
+
+            size_t dropped = output.DroppedLineCount();
+            size_t span_count = line_num >= dropped ? output.SpanCount(line_num - dropped) : 0;
+
+            if(span_count == 0) {
+                ImGui::TextUnformatted(line.data(), line.data() + line.size());
+                return;
+            }
+
+            // One text item per run of the same color
+            bool first_run = true;
+            size_t run_start = 0;
+            uint32_t color = 0;
+
+            for(size_t i = 0; i <= span_count; ++i) {
+                auto span = i < span_count ? output.Span(line_num - dropped, i) : ColorSpan{
+                    .offset = static_cast<uint32_t>(line.size()),
+                };
+
+                size_t run_end = std::min<size_t>(span.offset, line.size());
+
+                if(run_end > run_start) {
+                    if(!first_run) {
+                        ImGui::SameLine(0, 0);
+                    }
+
+                    first_run = false;
+
+                    if(color != 0) {
+                        ImGui::PushStyleColor(ImGuiCol_Text, color);
+                    }
+
+                    ImGui::TextUnformatted(line.data() + run_start, line.data() + run_end);
+
+                    if(color != 0) {
+                        ImGui::PopStyleColor();
+                    }
+
+                    run_start = run_end;
+                }
+
+                color = span.color;
+            }
+
+            // Still need to take up the line if it's empty
+            if(first_run) {
+                ImGui::TextUnformatted("");
+            }
+        };
+
+        ImGuiListClipper clipper;
+
+        if(filter.IsActive()) {
+            // Same as below but over the matching lines, skipping matches that have been dropped since
+            auto& matches = filter.Matches();
+            auto first_match = std::lower_bound(matches.begin(), matches.end(), first_line) - matches.begin();
+
+            clipper.Begin(static_cast<int>(matches.size() - first_match));
+
+            while(clipper.Step()) {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    render_line(matches[first_match + i]);
+                }
+            }
+        } else {
+            clipper.Begin(static_cast<int>(line_count - first_line));
+
+            while(clipper.Step()) {
+                for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    render_line(first_line + i);
+                }
+            }
+        }
+
+        if(at_bottom) {
+            ImGui::SetScrollHereY(1.0f);
+        }
 
         ImGui::EndChild();
+
+        if(has_process) {
+            ImGui::SetNextItemWidth(-1);
+
+            if(ImGui::InputTextWithHint("##stdin", "stdin", &view_state.stdin_text, ImGuiInputTextFlags_EnterReturnsTrue)) {
+                state.events.push_back(WriteStdinEvent{
+                    .text = std::move(view_state.stdin_text) + '\n',
+                });
+
+                view_state.stdin_text.clear();
+
+                // Keep typing without having to click back in
+                ImGui::SetKeyboardFocusHere(-1);
+            }
+        }
+
         ImGui::End();
     }
 
@@ -399,7 +904,7 @@ namespace lodeb {
 
         auto& ps = state.target_state->process_state;
 
-        if(ps->process.GetState() != lldb::eStateStopped) {
+        if(!ps->IsStopped()) {
             ImGui::Text("Running...");
 
             ImGui::End();
@@ -448,7 +953,7 @@ namespace lodeb {
 
         auto& ps = *state.target_state->process_state;
 
-        if(ps.process.GetState() != lldb::eStateStopped) {
+        if(!ps.IsStopped()) {
             ImGui::Text("Running...");
             
             ImGui::End();
@@ -457,109 +962,174 @@ namespace lodeb {
 
         auto frame = ps.process.GetSelectedThread().GetSelectedFrame();
 
-        lldb::SBVariablesOptions opts;
-        
-        opts.SetIncludeLocals(true);
-        opts.SetIncludeArguments(true);
-        opts.SetInScopeOnly(true);
+        auto& tree = state.locals_tree;
+        tree.Sync(ps.process, frame, state.memory_cache, state.value_formatters);
+
+        if(tree.IsStale() && tree.Roots().empty()) {
+            ImGui::Text("Loading...");
+
+            ImGui::End();
+            return;
+        }
+
+        if(ImGui::BeginTable("##vars", 3,
+                ImGuiTableFlags_BordersV |
+                ImGuiTableFlags_RowBg |
+                ImGuiTableFlags_Resizable |
+                ImGuiTableFlags_ScrollX |
+                ImGuiTableFlags_ScrollY)) {
+            ImGui::TableSetupScrollFreeze(0, 1);
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("Value");
+            ImGui::TableSetupColumn("Type");
+            ImGui::TableHeadersRow();
+
+            for(auto i = 0u; auto& node : tree.Roots()) {
+                ImGui::PushID(i);
+                VariableTreeNode(tree, node);
+                ImGui::PopID();
+
+                ++i;
+            }
+
+            ImGui::EndTable();
+        }
+
+        ImGui::End();
+    }
+
+    void AppLayer::VariableTreeNode(VariableTree& tree, VariableTree::Node& node) {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+
+        ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
+
+        if(!node.might_have_children) {
+            flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        }
+
+        bool expanded = tree.IsExpanded(node);
+
+        // We track what's open ourselves so that it carries over to the next stop
+        if(node.might_have_children) {
+            ImGui::SetNextItemOpen(expanded);
+        }
+
+        bool open = ImGui::TreeNodeEx(node.name.c_str(), flags);
 
-        // HACK(Apaar): Caching this
-        static uint32_t last_frame_id = (uint32_t)-1;
-        static lldb::addr_t last_frame_pc = (lldb::addr_t)-1;
+        if(node.might_have_children && open != expanded) {
+            tree.SetExpanded(node, open);
+        }
 
-        static std::vector<std::string> var_names;
-        static std::unordered_map<std::string, lldb::SBValue> name_to_value;
-        static std::unordered_map<std::string, std::string> name_to_desc;
+        ImGui::TableNextColumn();
 
-        if(frame.GetFrameID() != last_frame_id ||
-           frame.GetPC() != last_frame_pc) {
-            auto vars = frame.GetVariables(opts); 
+        if(tree.IsStale()) {
+            // These are from the previous stop, the fresh values are being fetched
+            ImGui::TextColored(ImVec4{0.5, 0.5, 0.5, 0.5}, "%s", node.value_str.c_str());
+        } else if(tree.Changed(node)) {
+            ImGui::TextColored(CHANGED_VALUE_COLOR, "%s", node.value_str.c_str());
+        } else {
+            ImGui::TextUnformatted(node.value_str.c_str());
+        }
 
-            last_frame_id = frame.GetFrameID();
-            last_frame_pc = frame.GetPC();
+        if(ImGui::BeginPopupContextItem("##value")) {
+            if(ImGui::MenuItem("Copy")) {
+                ImGui::SetClipboardText(node.value_str.c_str());
+            }
 
-            LogDebug("Getting variables again");
+            if(ImGui::MenuItem("Copy Description")) {
+                scratch_stream.Clear();
+                node.value.GetDescription(scratch_stream);
 
-            var_names.clear();
-            name_to_value.clear();
-            name_to_desc.clear();
+                ImGui::SetClipboardText(scratch_stream.GetData());
+            }
+
+            ImGui::Separator();
 
-            for(auto i = 0u; i < vars.GetSize(); ++i) {
-                auto var = vars.GetValueAtIndex(i);
-                auto addr = var.GetLoadAddress();
+            // Stale nodes might not be around anymore
+            bool can_watch = !tree.IsStale() && (node.value.IsValid() || node.addr != LLDB_INVALID_ADDRESS);
 
-                if(addr == (lldb::addr_t)-1) {
+            for(bool read : {false, true}) {
+                if(!ImGui::MenuItem(read ? "Watch Reads/Writes" : "Watch Writes", nullptr, false, can_watch)) {
                     continue;
                 }
 
-                auto var_name = var.GetName();
+                if(!node.value.IsValid()) {
+                    // Read straight from memory, so all we have is where it is
+                    state.events.push_back(AddWatchpointEvent{
+                        .expr = std::format("{:#x}", node.addr),
+                        .size = node.byte_size,
+                        .read = read,
+                    });
 
-                if(!var_name) {
                     continue;
                 }
 
-                auto name = std::format("{} at {:#010x}", var_name, var.GetLoadAddress());
+                scratch_stream.Clear();
+                node.value.GetExpressionPath(scratch_stream);
 
-                var_names.emplace_back(name);
-                name_to_value[name] = var;
+                state.events.push_back(AddWatchpointEvent{
+                    .value = node.value,
+                    .expr = scratch_stream.GetData() ? scratch_stream.GetData() : node.name,
+                    .read = read,
+                });
             }
+
+            ImGui::EndPopup();
         }
 
-        lldb::SBStream stream;
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("%s", node.type_name.c_str());
 
-        auto get_name_desc = [&](const std::string& var_name) -> const char* {
-            auto found_desc = name_to_desc.find(var_name);
+        if(!node.might_have_children || !open) {
+            return;
+        }
 
-            if(found_desc != name_to_desc.end()) {
-                return found_desc->second.c_str();
-            }
+        // Don't touch LLDB for stale nodes, we just show whatever we already had
+        auto& children = tree.IsStale() ? node.children : tree.Children(node);
 
-            auto found_value = name_to_value.find(var_name);
-            
-            if(found_value == name_to_value.end()) {
-                return nullptr;
-            }
+        if(node.num_children > VariableTree::PAGE_SIZE) {
+            // Only one page of children is fetched at a time
+            uint32_t page_end = std::min(node.num_children, node.page_start + VariableTree::PAGE_SIZE);
 
-            stream.Clear();
-            found_value->second.GetDescription(stream);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
 
-            std::string& s = name_to_desc[var_name];
-            s = stream.GetData();
+            ImGui::TextDisabled("[%u..%u] of %u", node.page_start, page_end - 1, node.num_children);
 
-            return s.c_str();
-        };
-        
+            ImGui::TableNextColumn();
 
-        ImGui::BeginChild("##vars", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
+            if(!tree.IsStale()) {
+                if(ImGui::SmallButton("<") && node.page_start > 0) {
+                    tree.SetPage(node, node.page_start - VariableTree::PAGE_SIZE);
+                }
 
-        for(auto i = 0u; const auto& var_name : var_names) {
-            ImGui::PushID(i);
+                ImGui::SameLine();
 
-            if(ImGui::TreeNode(var_name.c_str())) {
-                auto value = get_name_desc(var_name);
+                if(ImGui::SmallButton(">") && page_end < node.num_children) {
+                    tree.SetPage(node, page_end);
+                }
 
-                if(value) {
-                    ImGui::TextUnformatted(value);
+                ImGui::SameLine();
+                ImGui::SetNextItemWidth(120.0f);
 
-                    if(ImGui::BeginPopupContextItem("##local_vars")) {
-                        if(ImGui::MenuItem("Copy##local_vars_value")) {
-                            ImGui::SetClipboardText(value);
-                        }
+                uint32_t jump_index = node.page_start;
 
-                        ImGui::EndPopup();
-                    }
+                if(ImGui::InputScalar("Go to", ImGuiDataType_U32, &jump_index, nullptr, nullptr, nullptr, ImGuiInputTextFlags_EnterReturnsTrue)) {
+                    tree.SetPage(node, std::min(jump_index, node.num_children - 1));
                 }
-
-                ImGui::TreePop();
             }
+        }
 
+        for(auto i = 0u; auto& child : children) {
+            ImGui::PushID(i);
+            VariableTreeNode(tree, child);
             ImGui::PopID();
+
             ++i;
         }
 
-        ImGui::EndChild();
-
-        ImGui::End();
+        ImGui::TreePop();
     }
 
     void AppLayer::WindowFrames() {
@@ -581,26 +1151,36 @@ namespace lodeb {
 
         auto& ps = *state.target_state->process_state;
 
+        // The snapshot is from the last stop, don't let anyone pick a frame from it
+        if(!ps.IsStopped()) {
+            ImGui::Text("Running...");
+
+            ImGui::End();
+            return;
+        }
+
         auto thread = ps.process.GetSelectedThread();
-        auto selected_frame = thread.GetSelectedFrame();
+        auto selected_frame_id = thread.GetSelectedFrame().GetFrameID();
 
-        ImGui::BeginChild("##frames", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
+        auto& frames = state.frame_snapshot;
+        frames.Sync(ps.process, thread);
 
-        lldb::SBStream stream;
+        ImGui::BeginChild("##frames", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
 
-        for(auto i = 0u; i < thread.GetNumFrames(); ++i) {
-            auto frame = thread.GetFrameAtIndex(i);
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(frames.Size()));
 
-            stream.Clear();
-            frame.GetDescription(stream);
+        while(clipper.Step()) {
+            for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                ImGui::PushID(i);
 
-            ImGui::PushID(i);
+                // Frame IDs are just the index
+                if(ImGui::Selectable(frames.Description(i), static_cast<uint32_t>(i) == selected_frame_id)) {
+                    state.events.push_back(SetSelectedFrameEvent{static_cast<uint32_t>(i)});
+                }
 
-            if(ImGui::Selectable(stream.GetData(), frame.GetFrameID() == selected_frame.GetFrameID())) {
-                state.events.push_back(SetSelectedFrameEvent{i});
+                ImGui::PopID();
             }
-
-            ImGui::PopID();
         }
 
         ImGui::EndChild();
@@ -631,18 +1211,18 @@ namespace lodeb {
         bool values_out_of_date = 
             !state.target_state || 
             !state.target_state->process_state || 
-            (state.target_state->process_state->process.GetState() != lldb::eStateStopped);
+            !state.target_state->process_state->IsStopped();
 
         bool need_to_recompute = false;
 
-        for(int i = 0; auto& [expr, value]: state.watch_state.expr_values) {
+        for(int i = 0; auto& watch : state.watch_state.expr_values) {
             ImGui::TableNextRow();
 
             ImGui::TableNextColumn();
 
             ImGui::PushID(i);
 
-            ImGui::InputText("##expr", &expr);
+            ImGui::InputText("##expr", &watch.expr);
 
             if(ImGui::IsItemDeactivated()) {
                 need_to_recompute = true;
@@ -650,21 +1230,87 @@ namespace lodeb {
 
             ImGui::TableNextColumn();
 
-            if(values_out_of_date) {
-                // Grey out the text if not running
-                ImGui::TextColored(ImVec4{0.5, 0.5, 0.5, 0.5}, "%s", value.c_str());
+            if(values_out_of_date || watch.pending) {
+                // Grey out the text if not running (or if we're still evaluating it)
+                ImGui::TextColored(ImVec4{0.5, 0.5, 0.5, 0.5}, "%s", watch.value.c_str());
+            } else if(watch.timed_out) {
+                ImGui::TextColored(ImVec4{1.0, 0.7, 0.2, 1.0}, "%s", watch.value.c_str());
+            } else if(watch.changed) {
+                ImGui::TextColored(CHANGED_VALUE_COLOR, "%s", watch.value.c_str());
             } else {
-                ImGui::TextUnformatted(value.c_str());
+                ImGui::TextUnformatted(watch.value.c_str());
             }
 
+            if(!watch.benchmark.empty()) {
+                ImGui::SetItemTooltip("%s", watch.benchmark.c_str());
+            }
+
+            bool has_history = watch.history.Size() > 0;
+
             if(ImGui::BeginPopupContextItem("##watch_vars")) {
                 if(ImGui::MenuItem("Copy##watch_vars_value")) {
-                    ImGui::SetClipboardText(value.c_str());
+                    ImGui::SetClipboardText(watch.value.c_str());
+                }
+
+                ImGui::MenuItem("Plot History", nullptr, &watch.show_plot, has_history);
+
+                if(ImGui::MenuItem("Export History...", nullptr, false, has_history)) {
+                    const char* path = tinyfd_saveFileDialog("Export Watch History", "history.csv", 0, nullptr, nullptr);
+
+                    if(path) {
+                        watch.history.Export(path);
+                    }
+                }
+
+                // Uses what the evaluator already produced rather than evaluating it again,
+                // as long as it was produced for what's in the box now
+                bool can_watch = !values_out_of_date && !watch.pending &&
+                    watch.classified_expr == watch.expr && watch.result.IsValid();
+
+                for(bool read : {false, true}) {
+                    if(ImGui::MenuItem(read ? "Watch Reads/Writes" : "Watch Writes", nullptr, false, can_watch)) {
+                        state.events.push_back(AddWatchpointEvent{
+                            .value = watch.result,
+                            .expr = watch.expr,
+                            .read = read,
+                        });
+                    }
+                }
+
+                // Shown as a tooltip on the value
+                if(ImGui::MenuItem("Benchmark Formatter", nullptr, false, !values_out_of_date && !watch.expr.empty())) {
+                    state.events.push_back(BenchmarkWatchEvent{static_cast<size_t>(i)});
                 }
 
                 ImGui::EndPopup();
             }
 
+            if(watch.show_plot && has_history) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+
+                auto& history = watch.history;
+                auto& last = history[history.Size() - 1];
+
+                ImGui::TextDisabled("%zu stops", history.Size());
+
+                ImGui::TableNextColumn();
+
+                ImGui::PlotLines(
+                    "##history",
+                    [](void* data, int idx) {
+                        return static_cast<float>((*static_cast<ValueHistory*>(data))[idx].value);
+                    },
+                    &history,
+                    static_cast<int>(history.Size()),
+                    0,
+                    frame_arena.Format("{} at stop {}", last.value, last.stop_id),
+                    FLT_MAX,
+                    FLT_MAX,
+                    ImVec2{-1, 80}
+                );
+            }
+
             ImGui::PopID();
 
             i += 1;
@@ -693,6 +1339,111 @@ namespace lodeb {
         ImGui::End();
     }
     
+    void AppLayer::WindowMemory() {
+        ImGui::Begin("Memory");
+
+        auto& mvs = state.memory_view_state;
+
+        ImGui::SetNextItemWidth(300.0f);
+
+        if(ImGui::InputTextWithHint("##addr", "Address or expression", &mvs.addr_expr, ImGuiInputTextFlags_EnterReturnsTrue)) {
+            state.events.push_back(ViewMemoryEvent{
+                .expr = mvs.addr_expr,
+            });
+        }
+
+        if(!mvs.error.empty()) {
+            ImGui::SameLine();
+            ImGui::TextColored(ImVec4{1.0, 0.3, 0.3, 1.0}, "%s", mvs.error.c_str());
+        }
+
+        if(!state.target_state || !state.target_state->process_state) {
+            ImGui::Text("Process is not running");
+
+            ImGui::End();
+            return;
+        }
+
+        auto& ps = *state.target_state->process_state;
+
+        if(!ps.IsStopped()) {
+            ImGui::Text("Running...");
+
+            ImGui::End();
+            return;
+        }
+
+        if(!mvs.addr) {
+            ImGui::End();
+            return;
+        }
+
+        auto& cache = state.memory_cache;
+        auto stats = cache.GetStats();
+
+        ImGui::SameLine();
+        ImGui::TextDisabled(
+            "%zu pages cached, %zu hits, %zu misses in %zu reads this stop",
+            cache.PageCount(),
+            stats.hits,
+            stats.misses,
+            stats.reads
+        );
+
+        ImGui::BeginChild("##memory", {-1, -1}, ImGuiChildFlags_Border, ImGuiWindowFlags_HorizontalScrollbar);
+
+        // Rows are aligned so the columns line up with the low nibble of the address
+        lldb::addr_t start = *mvs.addr - *mvs.addr % MEMORY_BYTES_PER_ROW;
+
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(MEMORY_VIEW_SIZE / MEMORY_BYTES_PER_ROW));
+
+        while(clipper.Step()) {
+            // Whatever's on screen in one go
+            cache.Prefetch(
+                start + static_cast<lldb::addr_t>(clipper.DisplayStart) * MEMORY_BYTES_PER_ROW,
+                static_cast<size_t>(clipper.DisplayEnd - clipper.DisplayStart) * MEMORY_BYTES_PER_ROW
+            );
+
+            for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                lldb::addr_t row_addr = start + static_cast<lldb::addr_t>(i) * MEMORY_BYTES_PER_ROW;
+
+                uint8_t bytes[MEMORY_BYTES_PER_ROW];
+                size_t read = cache.Read(row_addr, bytes, sizeof(bytes));
+
+                // e.g. "0x00007ffc1234abc0  48 65 6c ...  |Hel...|"
+                char row[128];
+                char* out = row + snprintf(row, sizeof(row), "%#018llx  ", static_cast<unsigned long long>(row_addr));
+
+                for(size_t j = 0; j < MEMORY_BYTES_PER_ROW; ++j) {
+                    if(j < read) {
+                        out += snprintf(out, 4, "%02x ", bytes[j]);
+                    } else {
+                        out += snprintf(out, 4, "?? ");
+                    }
+
+                    if(j == MEMORY_BYTES_PER_ROW / 2 - 1) {
+                        *out++ = ' ';
+                    }
+                }
+
+                *out++ = ' ';
+                *out++ = '|';
+
+                for(size_t j = 0; j < MEMORY_BYTES_PER_ROW; ++j) {
+                    *out++ = (j < read && bytes[j] >= 0x20 && bytes[j] < 0x7F) ? static_cast<char>(bytes[j]) : '.';
+                }
+
+                *out++ = '|';
+
+                ImGui::TextUnformatted(row, out);
+            }
+        }
+
+        ImGui::EndChild();
+        ImGui::End();
+    }
+
     void AppLayer::WindowBreakpoints() {
         ImGui::Begin("Breakpoints");
 
@@ -711,4 +1462,128 @@ namespace lodeb {
 
         ImGui::End();
     }
+
+    void AppLayer::WindowWatchpoints() {
+        ImGui::Begin("Watchpoints");
+
+        if(!state.target_state) {
+            ImGui::Text("No target loaded");
+
+            ImGui::End();
+            return;
+        }
+
+        auto& wvs = state.watchpoint_view_state;
+        auto& watchpoints = state.target_state->watchpoints;
+
+        bool stopped = state.target_state->process_state &&
+            state.target_state->process_state->IsStopped();
+
+        ImGui::SetNextItemWidth(300.0f);
+        ImGui::InputTextWithHint("##expr", "Address or expression", &wvs.expr);
+
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+
+        // Only matters for plain addresses, expressions watch the whole value
+        ImGui::InputInt("Size", &wvs.size);
+        wvs.size = std::clamp(wvs.size, 1, 8);
+
+        ImGui::BeginDisabled(!stopped || wvs.expr.empty());
+
+        for(bool read : {false, true}) {
+            ImGui::SameLine();
+
+            if(ImGui::Button(read ? "Watch Reads/Writes" : "Watch Writes")) {
+                state.events.push_back(AddWatchpointEvent{
+                    .expr = wvs.expr,
+                    .size = static_cast<size_t>(wvs.size),
+                    .read = read,
+                });
+            }
+        }
+
+        ImGui::EndDisabled();
+
+        if(!watchpoints.Error().empty()) {
+            ImGui::TextColored(ImVec4{1.0, 0.3, 0.3, 1.0}, "%s", watchpoints.Error().c_str());
+        }
+
+        if(!ImGui::BeginTable("##watchpoints", 7,
+                ImGuiTableFlags_Borders |
+                ImGuiTableFlags_RowBg |
+                ImGuiTableFlags_Resizable |
+                ImGuiTableFlags_ScrollY)) {
+            ImGui::End();
+            return;
+        }
+
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("##enabled", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Watching");
+        ImGui::TableSetupColumn("Address", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Hits", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Value");
+        ImGui::TableSetupColumn("Last Hit");
+        ImGui::TableSetupColumn("##remove", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        for(auto& entry : watchpoints.Entries()) {
+            auto& wp = entry.watchpoint;
+
+            ImGui::PushID(wp.GetID());
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+
+            bool enabled = wp.IsEnabled();
+
+            if(ImGui::Checkbox("##enabled", &enabled)) {
+                wp.SetEnabled(enabled);
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(entry.expr.c_str());
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", entry.read ? "(r/w)" : "(w)");
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(frame_arena.Format("{:#x} [{}]", wp.GetWatchAddress(), wp.GetWatchSize()));
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", entry.hit_count);
+
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(entry.value.c_str());
+
+            ImGui::TableNextColumn();
+
+            if(entry.new_value.empty()) {
+                ImGui::TextDisabled("Not hit yet");
+            } else if(entry.old_value == entry.new_value) {
+                // Reads, or writes of the same value
+                ImGui::Text("%s (unchanged) at stop %u", entry.new_value.c_str(), entry.last_hit_stop_id);
+            } else {
+                ImGui::Text("%s", entry.old_value.c_str());
+                ImGui::SameLine();
+                ImGui::TextDisabled("->");
+                ImGui::SameLine();
+                ImGui::TextColored(CHANGED_VALUE_COLOR, "%s", entry.new_value.c_str());
+                ImGui::SameLine();
+                ImGui::TextDisabled("at stop %u", entry.last_hit_stop_id);
+            }
+
+            ImGui::TableNextColumn();
+
+            if(ImGui::SmallButton("X")) {
+                state.events.push_back(RemoveWatchpointEvent{wp.GetID()});
+            }
+
+            ImGui::PopID();
+        }
+
+        ImGui::EndTable();
+
+        ImGui::End();
+    }
 }
@@ -3,6 +3,7 @@
 #include <Application.hpp>
 
 #include "State.hpp"
+#include "FrameArena.hpp"
 
 namespace lodeb {
     class AppLayer: public Scaffold::IRenderUI, public Scaffold::IUpdate {
@@ -15,6 +16,12 @@ namespace lodeb {
     private:
         State state;
 
+        // Scratch memory for strings that only need to live for the current frame
+        FrameArena frame_arena;
+
+        // Reused so that we're not allocating a new stream every frame
+        lldb::SBStream scratch_stream;
+
         void WindowTargetSettings();
         void WindowCommandBar();
         void WindowSourceView();
@@ -24,5 +31,9 @@ namespace lodeb {
         void WindowFrames();
         void WindowWatch();
         void WindowBreakpoints();
+        void WindowMemory();
+        void WindowWatchpoints();
+
+        void VariableTreeNode(VariableTree& tree, VariableTree::Node& node);
     };
 }
@@ -0,0 +1,171 @@
+#include "BreakableLineCache.hpp"
+
+#include <algorithm>
+
+#include "Log.hpp"
+
+namespace lodeb {
+    const BreakableLineCache::Lines* BreakableLineCache::Find(lldb::SBTarget& target, const std::string& path) {
+        auto found = file_lines.find(path);
+
+        const Lines* lines = found != file_lines.end() ? &found->second.lines : nullptr;
+
+        if(lines && found->second.modules_generation == modules_generation) {
+            return lines;
+        }
+
+        if(pending.contains(path)) {
+            return lines;
+        }
+
+        std::unordered_set<std::string> skip_module_keys;
+
+        for(auto& [module_key, path_to_lines] : module_to_file_lines) {
+            if(path_to_lines.contains(path)) {
+                skip_module_keys.insert(module_key);
+            }
+        }
+
+        LogDebug("Kicking off task to find breakable lines in {}", path);
+
+        // HACK(Apaar): Same as the symbol cache, this reads from the target on another thread.
+        pending[path] = std::async(std::launch::async, Compute, target, path, modules_generation, std::move(skip_module_keys));
+
+        return lines;
+    }
+
+    void BreakableLineCache::Update() {
+        for(auto iter = pending.begin(); iter != pending.end();) {
+            if(iter->second.wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+                ++iter;
+                continue;
+            }
+
+            auto result = iter->second.get();
+            iter = pending.erase(iter);
+
+            for(auto& [module_key, lines] : result.module_lines) {
+                module_to_file_lines[module_key][result.path] = std::move(lines);
+            }
+
+            if(result.modules_generation != modules_generation) {
+                // Stale, the next `Find` will pick up the remaining modules
+                continue;
+            }
+
+            auto& file = file_lines[result.path];
+
+            file.modules_generation = result.modules_generation;
+
+            auto& merged = file.lines;
+
+            merged.clear();
+
+            for(auto& [module_key, path_to_lines] : module_to_file_lines) {
+                auto found = path_to_lines.find(result.path);
+
+                if(found != path_to_lines.end()) {
+                    merged.insert(merged.end(), found->second.begin(), found->second.end());
+                }
+            }
+
+            std::sort(merged.begin(), merged.end());
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+
+            LogDebug("Found {} breakable lines in {}", merged.size(), result.path);
+        }
+    }
+
+    void BreakableLineCache::OnModulesLoaded() {
+        // The per-module results are still good, we just need to pick up
+        // lines from the new modules next time each file is requested. Until
+        // then the merged lines we have are marked stale (but still used).
+        modules_generation += 1;
+    }
+
+    std::optional<int> BreakableLineCache::SnapToBreakable(const Lines& lines, int line) {
+        auto found = std::lower_bound(lines.begin(), lines.end(), line);
+
+        if(found == lines.end()) {
+            return std::nullopt;
+        }
+
+        return *found;
+    }
+
+    std::string BreakableLineCache::ModuleKey(lldb::SBModule& mod) {
+        if(auto* uuid = mod.GetUUIDString()) {
+            return uuid;
+        }
+
+        char buf[1024];
+
+        mod.GetFileSpec().GetPath(buf, sizeof(buf));
+
+        return buf;
+    }
+
+    BreakableLineCache::Result BreakableLineCache::Compute(
+        lldb::SBTarget target,
+        std::string path,
+        uint32_t modules_generation,
+        std::unordered_set<std::string> skip_module_keys
+    ) {
+        Result result = {
+            .path = path,
+            .modules_generation = modules_generation,
+        };
+
+        lldb::SBFileSpec file_spec{path.c_str(), false};
+
+        char buf[1024];
+
+        for(auto mod_i = 0u; mod_i < target.GetNumModules(); ++mod_i) {
+            auto mod = target.GetModuleAtIndex(mod_i);
+            auto module_key = ModuleKey(mod);
+
+            if(skip_module_keys.contains(module_key)) {
+                continue;
+            }
+
+            // We store an entry even if it's empty so we don't walk this module again
+            auto& module_lines = result.module_lines.emplace_back(ModuleLines{
+                .module_key = std::move(module_key),
+            });
+
+            for(auto cu_i = 0u; cu_i < mod.GetNumCompileUnits(); ++cu_i) {
+                auto cu = mod.GetCompileUnitAtIndex(cu_i);
+
+                // Skip compile units which don't include this file at all
+                if(cu.FindSupportFileIndex(0, file_spec, true) == UINT32_MAX) {
+                    continue;
+                }
+
+                for(auto le_i = 0u; le_i < cu.GetNumLineEntries(); ++le_i) {
+                    auto le = cu.GetLineEntryAtIndex(le_i);
+
+                    if(le.GetLine() == 0) {
+                        continue;
+                    }
+
+                    le.GetFileSpec().GetPath(buf, sizeof(buf));
+
+                    if(path != buf) {
+                        continue;
+                    }
+
+                    module_lines.lines.push_back(static_cast<int>(le.GetLine()));
+                }
+            }
+
+            // Many line entries map to the same line
+            std::sort(module_lines.lines.begin(), module_lines.lines.end());
+            module_lines.lines.erase(
+                std::unique(module_lines.lines.begin(), module_lines.lines.end()),
+                module_lines.lines.end()
+            );
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <vector>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <lldb/API/LLDB.h>
+
+namespace lodeb {
+    // Caches which lines of a source file actually have code (i.e. can have a
+    // breakpoint resolved to them) by walking the line tables of every compile
+    // unit that references the file.
+    //
+    // This is computed lazily on a worker the first time a file is requested.
+    // Results are cached per module so that when new modules are loaded
+    // (e.g. shared libraries at process launch) we only walk those.
+    class BreakableLineCache {
+    public:
+        using Lines = std::vector<int>;
+
+        // Returns the sorted breakable lines for `path`, or nullptr if they're
+        // still being computed (in which case this kicks off the computation).
+        // After modules are loaded, the lines we had are returned until the
+        // recomputed ones replace them.
+        const Lines* Find(lldb::SBTarget& target, const std::string& path);
+
+        // Picks up any finished computations. Call once per frame.
+        void Update();
+
+        // Forces files to be re-merged (walking only the modules we haven't seen)
+        void OnModulesLoaded();
+
+        // Returns `line` if it's breakable, otherwise the next breakable line after it
+        static std::optional<int> SnapToBreakable(const Lines& lines, int line);
+
+    private:
+        struct ModuleLines {
+            std::string module_key;
+            Lines lines;
+        };
+
+        struct Result {
+            std::string path;
+            uint32_t modules_generation = 0;
+            std::vector<ModuleLines> module_lines;
+        };
+
+        // module key -> file path -> lines
+        std::unordered_map<std::string, std::unordered_map<std::string, Lines>> module_to_file_lines;
+
+        struct FileLines {
+            Lines lines;
+
+            // Stale if this isn't `modules_generation`
+            uint32_t modules_generation = 0;
+        };
+
+        // Union of the above for each file across all modules
+        std::unordered_map<std::string, FileLines> file_lines;
+
+        std::unordered_map<std::string, std::future<Result>> pending;
+
+        // Bumped whenever modules are loaded so we don't publish a merged result
+        // that was computed before the new modules were around.
+        uint32_t modules_generation = 0;
+
+        static std::string ModuleKey(lldb::SBModule& mod);
+
+        static Result Compute(
+            lldb::SBTarget target,
+            std::string path,
+            uint32_t modules_generation,
+            std::unordered_set<std::string> skip_module_keys
+        );
+    };
+}
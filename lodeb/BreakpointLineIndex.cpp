@@ -0,0 +1,106 @@
+#include "BreakpointLineIndex.hpp"
+
+#include <algorithm>
+
+#include "LLDBUtil.hpp"
+
+namespace lodeb {
+    void BreakpointLineIndex::Rebuild(std::unordered_map<FileLoc, lldb::SBBreakpoint>& loc_to_breakpoint) {
+        // Files that still have breakpoints reuse their vectors, the rest are dropped below
+        for(auto& [path, entries] : path_to_entries) {
+            entries.clear();
+        }
+
+        for(auto& [loc, bp] : loc_to_breakpoint) {
+            auto& entries = path_to_entries[loc.path];
+
+            bool any_in_file = false;
+
+            for(auto i = 0u; i < bp.GetNumLocations(); ++i) {
+                auto addr = bp.GetLocationAtIndex(i).GetAddress();
+                auto resolved_loc = AddrLoc(addr);
+
+                // LLDB may resolve to a different file (e.g. an inlined header), in
+                // which case we just show it at the requested line below.
+                if(!resolved_loc || resolved_loc->path != loc.path) {
+                    continue;
+                }
+
+                entries.push_back(Entry{
+                    .line = resolved_loc->line,
+                    .requested_lines = {loc.line},
+                    .resolved = true,
+                });
+
+                any_in_file = true;
+            }
+
+            if(!any_in_file) {
+                entries.push_back(Entry{
+                    .line = loc.line,
+                    .requested_lines = {loc.line},
+                    .resolved = bp.GetNumLocations() > 0,
+                });
+            }
+        }
+
+        std::erase_if(path_to_entries, [](const auto& pair) {
+            return pair.second.empty();
+        });
+
+        for(auto& [path, entries] : path_to_entries) {
+            std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+                return a.line < b.line;
+            });
+
+            // Multiple locations can map to the same line (e.g. template instantiations),
+            // as can different breakpoints. Merge them so there's one entry per line.
+            size_t out = 0;
+
+            for(size_t i = 0; i < entries.size(); ++i) {
+                if(out > 0 && entries[out - 1].line == entries[i].line) {
+                    auto& merged = entries[out - 1];
+
+                    for(int requested_line : entries[i].requested_lines) {
+                        if(std::find(merged.requested_lines.begin(), merged.requested_lines.end(), requested_line) == merged.requested_lines.end()) {
+                            merged.requested_lines.push_back(requested_line);
+                        }
+                    }
+
+                    merged.resolved = merged.resolved || entries[i].resolved;
+                    continue;
+                }
+
+                if(out != i) {
+                    entries[out] = std::move(entries[i]);
+                }
+
+                out += 1;
+            }
+
+            entries.resize(out);
+        }
+    }
+
+    const BreakpointLineIndex::FileEntries* BreakpointLineIndex::FindFile(const std::string& path) const {
+        auto found = path_to_entries.find(path);
+
+        if(found == path_to_entries.end()) {
+            return nullptr;
+        }
+
+        return &found->second;
+    }
+
+    const BreakpointLineIndex::Entry* BreakpointLineIndex::FindLine(const FileEntries& entries, int line) {
+        auto found = std::lower_bound(entries.begin(), entries.end(), line, [](const Entry& e, int line) {
+            return e.line < line;
+        });
+
+        if(found == entries.end() || found->line != line) {
+            return nullptr;
+        }
+
+        return &*found;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <lldb/API/LLDB.h>
+
+#include "FileLoc.hpp"
+
+namespace lodeb {
+    // Breakpoints grouped by file and sorted by line so the source view
+    // can look them up by line number alone instead of constructing and
+    // hashing a `FileLoc` for every rendered line.
+    //
+    // This is derived from `TargetState::loc_to_breakpoint` and has to be
+    // rebuilt whenever that changes or LLDB (re)resolves a breakpoint.
+    class BreakpointLineIndex {
+    public:
+        struct Entry {
+            // Line the breakpoint actually resolved to (or the requested
+            // line if it has no locations in this file).
+            int line = 0;
+
+            // Lines the breakpoints on this line were requested at, i.e. their
+            // keys in `loc_to_breakpoint`. Needed to toggle them off again. There
+            // can be several if more than one resolved to the same line.
+            std::vector<int> requested_lines;
+
+            // Whether any of them resolved to an actual location
+            bool resolved = false;
+        };
+
+        using FileEntries = std::vector<Entry>;
+
+        void Rebuild(std::unordered_map<FileLoc, lldb::SBBreakpoint>& loc_to_breakpoint);
+
+        // Returns nullptr if there are no breakpoints in the given file
+        const FileEntries* FindFile(const std::string& path) const;
+
+        static const Entry* FindLine(const FileEntries& entries, int line);
+
+    private:
+        std::unordered_map<std::string, FileEntries> path_to_entries;
+    };
+}
@@ -0,0 +1,59 @@
+#include "FrameArena.hpp"
+
+#include <cstring>
+#include <cstdint>
+
+namespace lodeb {
+    FrameArena::FrameArena(size_t capacity):
+        main_block{std::make_unique<char[]>(capacity)},
+        capacity{capacity} {}
+
+    void FrameArena::Reset() {
+        if(!overflow_blocks.empty()) {
+            // Grow so that a frame like the last one fits entirely in the main block
+            size_t new_capacity = capacity;
+
+            while(new_capacity < used + overflow_bytes) {
+                new_capacity *= 2;
+            }
+
+            main_block = std::make_unique<char[]>(new_capacity);
+            capacity = new_capacity;
+
+            overflow_blocks.clear();
+            overflow_bytes = 0;
+        }
+
+        used = 0;
+    }
+
+    void* FrameArena::Alloc(size_t size, size_t align) {
+        auto base = reinterpret_cast<uintptr_t>(main_block.get());
+        auto aligned = (base + used + align - 1) & ~(uintptr_t{align} - 1);
+
+        size_t offset = aligned - base;
+
+        if(offset + size <= capacity) {
+            used = offset + size;
+            return main_block.get() + offset;
+        }
+
+        // new[] of char is only guaranteed max_align_t alignment
+        auto& block = overflow_blocks.emplace_back(std::make_unique<char[]>(size + align));
+        overflow_bytes += size + align;
+
+        auto block_base = reinterpret_cast<uintptr_t>(block.get());
+        auto block_aligned = (block_base + align - 1) & ~(uintptr_t{align} - 1);
+
+        return block.get() + (block_aligned - block_base);
+    }
+
+    const char* FrameArena::Copy(std::string_view str) {
+        auto* dest = static_cast<char*>(Alloc(str.size() + 1, 1));
+
+        std::memcpy(dest, str.data(), str.size());
+        dest[str.size()] = '\0';
+
+        return dest;
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <format>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace lodeb {
+    // Bump allocator for data which only needs to live until the end of the
+    // current UI frame (labels, formatted lines, etc). Reset at the start of
+    // every frame.
+    //
+    // If a frame overflows the main block we allocate extra blocks, and on the
+    // next `Reset` we grow the main block to fit all of them so that steady-state
+    // frames don't touch the heap at all.
+    class FrameArena {
+    public:
+        explicit FrameArena(size_t capacity = 64 * 1024);
+
+        void Reset();
+
+        void* Alloc(size_t size, size_t align = alignof(std::max_align_t));
+
+        // Returns a null-terminated copy of `str`
+        const char* Copy(std::string_view str);
+
+        // Like `std::format` but the null-terminated result lives in the arena
+        template <typename... Args>
+        const char* Format(std::format_string<Args...> fmt, Args&&... args) {
+            // Optimistically format into whatever is left in the current block and only
+            // fall back to an exactly-sized allocation if it didn't fit.
+            auto* dest = main_block.get() + used;
+            size_t avail = capacity - used;
+
+            auto res = std::format_to_n(dest, avail, fmt, std::forward<Args>(args)...);
+            size_t len = static_cast<size_t>(res.size);
+
+            if(len < avail) {
+                dest[len] = '\0';
+                used += len + 1;
+
+                return dest;
+            }
+
+            auto* overflow = static_cast<char*>(Alloc(len + 1, 1));
+
+            std::format_to_n(overflow, len, fmt, std::forward<Args>(args)...);
+            overflow[len] = '\0';
+
+            return overflow;
+        }
+
+        size_t BytesUsed() const { return used + overflow_bytes; }
+
+    private:
+        std::unique_ptr<char[]> main_block;
+
+        size_t capacity = 0;
+        size_t used = 0;
+
+        std::vector<std::unique_ptr<char[]>> overflow_blocks;
+        size_t overflow_bytes = 0;
+    };
+}
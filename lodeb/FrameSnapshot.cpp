@@ -0,0 +1,45 @@
+#include "FrameSnapshot.hpp"
+
+#include <string_view>
+
+#include "Log.hpp"
+
+namespace lodeb {
+    void FrameSnapshot::Sync(lldb::SBProcess& process, lldb::SBThread& thread) {
+        auto new_key = StopKey::ForThread(process, thread);
+
+        if(key == new_key) {
+            return;
+        }
+
+        key = new_key;
+
+        text.clear();
+        offsets.clear();
+
+        auto num_frames = thread.GetNumFrames();
+
+        offsets.reserve(num_frames);
+
+        lldb::SBStream stream;
+
+        for(auto i = 0u; i < num_frames; ++i) {
+            stream.Clear();
+            thread.GetFrameAtIndex(i).GetDescription(stream);
+
+            offsets.push_back(static_cast<uint32_t>(text.size()));
+
+            // The descriptions end in a newline, which we don't want
+            std::string_view desc{stream.GetData() ? stream.GetData() : "", stream.GetSize()};
+
+            while(!desc.empty() && (desc.back() == '\n' || desc.back() == '\r')) {
+                desc.remove_suffix(1);
+            }
+
+            text += desc;
+            text += '\0';
+        }
+
+        LogDebug("Captured {} frames for stop {}", num_frames, new_key.stop_id);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "StopKey.hpp"
+
+namespace lodeb {
+    // The stack of the selected thread, formatted once per stop (or when a
+    // different thread is selected) so the frames window doesn't have to go
+    // through LLDB for every frame every time it's drawn.
+    class FrameSnapshot {
+    public:
+        // Captures the stack again if we're at a different stop/thread than last time
+        void Sync(lldb::SBProcess& process, lldb::SBThread& thread);
+
+        size_t Size() const { return offsets.size(); }
+
+        // What `SBFrame::GetDescription` gave us for the frame at `idx`
+        const char* Description(size_t idx) const { return text.data() + offsets[idx]; }
+
+    private:
+        std::optional<StopKey> key;
+
+        // Every description back to back, each one null terminated
+        std::string text;
+        std::vector<uint32_t> offsets;
+    };
+}
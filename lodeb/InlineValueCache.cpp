@@ -0,0 +1,179 @@
+#include "InlineValueCache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+
+namespace {
+    // Keep annotations from running off into the distance
+    constexpr size_t MAX_VALUE_LEN = 40;
+    constexpr int MAX_VARS_PER_LINE = 8;
+
+    bool IsIdentStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool IsIdentChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+}
+
+namespace lodeb {
+    void InlineValueCache::Sync(lldb::SBProcess& process, lldb::SBFrame& frame) {
+        auto new_key = StopKey::ForFrame(process, frame);
+
+        if(key == new_key) {
+            return;
+        }
+
+        key = new_key;
+
+        this->frame = frame;
+
+        vars.clear();
+        vars_loaded = false;
+
+        line_to_annotation.clear();
+    }
+
+    const std::string& InlineValueCache::ForLine(int line_num, std::string_view line) {
+        auto found = line_to_annotation.find(line_num);
+
+        if(found != line_to_annotation.end()) {
+            return found->second;
+        }
+
+        if(!vars_loaded) {
+            LoadVars();
+        }
+
+        auto& annotation = line_to_annotation[line_num];
+
+        // Identifiers we've already annotated on this line
+        std::vector<std::string_view> seen;
+
+        for(size_t i = 0; i < line.size() && static_cast<int>(seen.size()) < MAX_VARS_PER_LINE;) {
+            char c = line[i];
+
+            // Don't bother with anything in comments
+            if(c == '/' && i + 1 < line.size() && line[i + 1] == '/') {
+                break;
+            }
+
+            // Skip string/char literals
+            if(c == '"' || c == '\'') {
+                for(i += 1; i < line.size() && line[i] != c; ++i) {
+                    if(line[i] == '\\') {
+                        i += 1;
+                    }
+                }
+
+                i += 1;
+                continue;
+            }
+
+            if(!IsIdentStart(c)) {
+                i += 1;
+                continue;
+            }
+
+            size_t start = i;
+
+            while(i < line.size() && IsIdentChar(line[i])) {
+                i += 1;
+            }
+
+            auto ident = line.substr(start, i - start);
+
+            // Member accesses (foo.bar, foo->bar) aren't locals
+            bool is_member = (start >= 1 && line[start - 1] == '.') ||
+                             (start >= 2 && line[start - 2] == '-' && line[start - 1] == '>');
+
+            if(is_member || std::find(seen.begin(), seen.end(), ident) != seen.end()) {
+                continue;
+            }
+
+            auto* var = FindVar(ident);
+
+            if(!var) {
+                continue;
+            }
+
+            auto value = var->value;
+
+            // Scalars have a value, things like strings and containers have a summary.
+            // Aggregates have neither and would need their children formatted, so skip them.
+            const char* value_str = value.GetValue();
+
+            if(!value_str) {
+                value_str = value.GetSummary();
+            }
+
+            if(!value_str) {
+                continue;
+            }
+
+            seen.push_back(ident);
+
+            std::string_view value_view = value_str;
+
+            if(!annotation.empty()) {
+                annotation += ", ";
+            }
+
+            if(value_view.size() > MAX_VALUE_LEN) {
+                std::format_to(std::back_inserter(annotation), "{} = {}...", ident, value_view.substr(0, MAX_VALUE_LEN));
+            } else {
+                std::format_to(std::back_inserter(annotation), "{} = {}", ident, value_view);
+            }
+        }
+
+        return annotation;
+    }
+
+    void InlineValueCache::LoadVars() {
+        vars_loaded = true;
+
+        if(!frame.IsValid()) {
+            return;
+        }
+
+        lldb::SBVariablesOptions opts;
+
+        opts.SetIncludeLocals(true);
+        opts.SetIncludeArguments(true);
+        opts.SetInScopeOnly(true);
+
+        auto values = frame.GetVariables(opts);
+
+        for(auto i = 0u; i < values.GetSize(); ++i) {
+            auto value = values.GetValueAtIndex(i);
+            auto* name = value.GetName();
+
+            if(!name) {
+                continue;
+            }
+
+            vars.push_back(Var{
+                .name = name,
+                .value = value,
+            });
+        }
+
+        std::sort(vars.begin(), vars.end(), [](const Var& a, const Var& b) {
+            return a.name < b.name;
+        });
+    }
+
+    const InlineValueCache::Var* InlineValueCache::FindVar(std::string_view name) const {
+        auto found = std::lower_bound(vars.begin(), vars.end(), name, [](const Var& var, std::string_view name) {
+            return var.name < name;
+        });
+
+        if(found == vars.end() || found->name != name) {
+            return nullptr;
+        }
+
+        return &*found;
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+
+#include <lldb/API/LLDB.h>
+
+#include "StopKey.hpp"
+
+namespace lodeb {
+    // Values of the locals referenced on a line of source, shown as inline
+    // annotations in the source view.
+    //
+    // Annotations are computed lazily (only for lines that actually get drawn)
+    // straight from the frame's `SBValue`s, so no expressions are evaluated.
+    // Everything is thrown away when the stop or selected frame changes.
+    class InlineValueCache {
+    public:
+        // Drops all cached values if we're at a different stop/frame than last time
+        void Sync(lldb::SBProcess& process, lldb::SBFrame& frame);
+
+        // Returns e.g. "i = 3, count = 10", or an empty string if the line
+        // doesn't reference any locals.
+        const std::string& ForLine(int line_num, std::string_view line);
+
+    private:
+        struct Var {
+            // Owned by LLDB's string pool
+            std::string_view name;
+            lldb::SBValue value;
+        };
+
+        std::optional<StopKey> key;
+
+        lldb::SBFrame frame;
+
+        // Sorted by name, fetched on first use after a stop
+        std::vector<Var> vars;
+        bool vars_loaded = false;
+
+        std::unordered_map<int, std::string> line_to_annotation;
+
+        void LoadVars();
+        const Var* FindVar(std::string_view name) const;
+    };
+}
@@ -0,0 +1,185 @@
+#include "MemoryPageCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace lodeb {
+    void MemoryPageCache::Sync(lldb::SBProcess& process) {
+        auto new_stop_id = process.GetStopID();
+
+        std::lock_guard lock{mutex};
+
+        bool same_process = this->process.IsValid() && this->process.GetUniqueID() == process.GetUniqueID();
+
+        if(same_process && stop_id == new_stop_id) {
+            return;
+        }
+
+        this->process = process;
+        stop_id = new_stop_id;
+
+        pages.clear();
+        stats = {};
+    }
+
+    void MemoryPageCache::Prefetch(lldb::addr_t addr, size_t size) {
+        if(size == 0) {
+            return;
+        }
+
+        lldb::addr_t first_page = addr - addr % PAGE_SIZE;
+        lldb::addr_t last_page = (addr + size - 1) - (addr + size - 1) % PAGE_SIZE;
+
+        // Runs of missing pages, as (first page, page count)
+        std::vector<std::pair<lldb::addr_t, size_t>> runs;
+
+        lldb::SBProcess process;
+        std::optional<uint32_t> stop_id;
+
+        {
+            std::lock_guard lock{mutex};
+
+            process = this->process;
+            stop_id = this->stop_id;
+
+            for(lldb::addr_t page = first_page; page <= last_page; page += PAGE_SIZE) {
+                if(pages.contains(page)) {
+                    continue;
+                }
+
+                bool extends_run = !runs.empty() &&
+                    runs.back().first + runs.back().second * PAGE_SIZE == page &&
+                    (runs.back().second + 1) * PAGE_SIZE <= MAX_BATCH_SIZE;
+
+                if(extends_run) {
+                    runs.back().second += 1;
+                } else {
+                    runs.push_back({page, 1});
+                }
+            }
+        }
+
+        if(runs.empty() || !process.IsValid()) {
+            return;
+        }
+
+        std::unordered_map<lldb::addr_t, Page> new_pages;
+        size_t reads = 0;
+        size_t misses = 0;
+
+        for(auto [run_first, run_count] : runs) {
+            reads += ReadPages(process, run_first, run_count, new_pages);
+            misses += run_count;
+        }
+
+        std::lock_guard lock{mutex};
+
+        if(this->stop_id != stop_id) {
+            // The process moved on while we were reading
+            return;
+        }
+
+        for(auto& [page_addr, page] : new_pages) {
+            pages.emplace(page_addr, std::move(page));
+        }
+
+        stats.misses += misses;
+        stats.reads += reads;
+    }
+
+    size_t MemoryPageCache::Read(lldb::addr_t addr, void* out, size_t size) {
+        Prefetch(addr, size);
+
+        auto* dest = static_cast<uint8_t*>(out);
+
+        std::lock_guard lock{mutex};
+
+        size_t done = 0;
+
+        while(done < size) {
+            lldb::addr_t cur = addr + done;
+            lldb::addr_t page_addr = cur - cur % PAGE_SIZE;
+
+            auto found = pages.find(page_addr);
+
+            if(found == pages.end()) {
+                break;
+            }
+
+            auto& page = found->second;
+
+            // The first use is what the page was fetched for, anything after that
+            // would've been another trip to the process without us.
+            if(page.fresh) {
+                page.fresh = false;
+            } else if(!page.reused) {
+                page.reused = true;
+                stats.hits += 1;
+            }
+
+            size_t offset = cur - page_addr;
+
+            if(offset >= page.size) {
+                break;
+            }
+
+            size_t n = std::min(size - done, page.size - offset);
+
+            std::memcpy(dest + done, page.data.get() + offset, n);
+            done += n;
+
+            // The rest of this page is unreadable
+            if(offset + n < PAGE_SIZE && done < size) {
+                break;
+            }
+        }
+
+        return done;
+    }
+
+    size_t MemoryPageCache::PageCount() const {
+        std::lock_guard lock{mutex};
+        return pages.size();
+    }
+
+    MemoryPageCache::Stats MemoryPageCache::GetStats() const {
+        std::lock_guard lock{mutex};
+        return stats;
+    }
+
+    size_t MemoryPageCache::ReadPages(
+        lldb::SBProcess& process,
+        lldb::addr_t first_page,
+        size_t page_count,
+        std::unordered_map<lldb::addr_t, Page>& into
+    ) {
+        size_t len = page_count * PAGE_SIZE;
+
+        std::unique_ptr<uint8_t[]> buf{new uint8_t[len]};
+
+        lldb::SBError err;
+        size_t read = process.ReadMemory(first_page, buf.get(), len, err);
+
+        // Everything up to and including the page where the read stopped
+        size_t covered = std::min(page_count, read / PAGE_SIZE + 1);
+
+        for(size_t i = 0; i < covered; ++i) {
+            Page page = {
+                .data = std::unique_ptr<uint8_t[]>{new uint8_t[PAGE_SIZE]},
+                .size = std::min(PAGE_SIZE, read - std::min(read, i * PAGE_SIZE)),
+            };
+
+            std::memcpy(page.data.get(), buf.get() + i * PAGE_SIZE, page.size);
+
+            into.emplace(first_page + i * PAGE_SIZE, std::move(page));
+        }
+
+        if(covered == page_count) {
+            return 1;
+        }
+
+        // There was a hole, but the pages after it might still be readable
+        return 1 + ReadPages(process, first_page + covered * PAGE_SIZE, page_count - covered, into);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+#include <lldb/API/LLDB.h>
+
+namespace lodeb {
+    // Process memory read a page at a time and kept until the process resumes
+    // (i.e. the stop ID changes), so that repeatedly looking at the same memory
+    // costs one `ReadMemory` per page rather than one per access.
+    //
+    // There's one of these in `State` which everything that reads memory goes
+    // through. Missing pages which are next to each other are read in one go.
+    //
+    // Safe to read from workers: the lock isn't held while reading from the
+    // process, and pages read for a stop that has since passed are thrown away.
+    class MemoryPageCache {
+    public:
+        static constexpr size_t PAGE_SIZE = 4096;
+
+        // Upper bound on a single batched read
+        static constexpr size_t MAX_BATCH_SIZE = 1024 * 1024;
+
+        // Since the last time the cache was cleared, i.e. for this stop
+        struct Stats {
+            // Pages read more than once, i.e. reads we saved. Each page only counts
+            // once, so looking at the same memory every frame doesn't inflate this.
+            size_t hits = 0;
+
+            // Pages which had to be read
+            size_t misses = 0;
+
+            // `ReadMemory` calls, i.e. round trips to the process
+            size_t reads = 0;
+        };
+
+        // Drops every page if this is a different process or stop than last time
+        void Sync(lldb::SBProcess& process);
+
+        // Reads any pages in [addr, addr + size) which aren't cached yet, merging
+        // runs of adjacent missing pages into a single read.
+        void Prefetch(lldb::addr_t addr, size_t size);
+
+        // Copies up to `size` bytes starting at `addr` into `out`, prefetching whatever
+        // isn't cached. Returns how many bytes could be read, stopping at the first one
+        // that couldn't.
+        size_t Read(lldb::addr_t addr, void* out, size_t size);
+
+        size_t PageCount() const;
+        Stats GetStats() const;
+
+    private:
+        struct Page {
+            std::unique_ptr<uint8_t[]> data;
+
+            // Reads stop at the first unreadable byte, so this can be less than `PAGE_SIZE`
+            size_t size = 0;
+
+            // For `Stats::hits`
+            bool fresh = true;
+            bool reused = false;
+        };
+
+        mutable std::mutex mutex;
+
+        lldb::SBProcess process;
+        std::optional<uint32_t> stop_id;
+
+        // Keyed by the page's address
+        std::unordered_map<lldb::addr_t, Page> pages;
+
+        Stats stats;
+
+        // Reads `page_count` pages starting at `first_page` with as few reads as possible
+        static size_t ReadPages(
+            lldb::SBProcess& process,
+            lldb::addr_t first_page,
+            size_t page_count,
+            std::unordered_map<lldb::addr_t, Page>& into
+        );
+    };
+}
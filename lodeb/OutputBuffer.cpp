@@ -0,0 +1,181 @@
+#include "OutputBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace lodeb {
+    OutputBuffer::OutputBuffer(size_t max_bytes): max_bytes{max_bytes} {}
+
+    void OutputBuffer::Append(std::string_view text, std::span<const ColorSpan> text_spans) {
+        // Offset of `text` into what we were originally given, for `text_spans`
+        size_t pos = 0;
+
+        size_t span_idx = 0;
+        uint32_t color = 0;
+
+        while(!text.empty()) {
+            auto newline = text.find('\n');
+            auto piece = text.substr(0, newline);
+
+            if(!last_line_open) {
+                lines.emplace_back();
+                last_line_open = true;
+            }
+
+            // Whatever color was in effect at the start of this piece
+            while(span_idx < text_spans.size() && text_spans[span_idx].offset <= pos) {
+                color = text_spans[span_idx++].color;
+            }
+
+            size_t line_offset = lines.back().len;
+
+            // Lines without newlines (e.g. progress bars redrawn with '\r') would otherwise
+            // grow forever, since we can't drop the chunk we're appending to.
+            auto kept = piece.substr(0, MaxLineLen() - std::min(MaxLineLen(), line_offset));
+
+            if(!kept.empty()) {
+                PushSpan(line_offset, color);
+
+                while(span_idx < text_spans.size() && text_spans[span_idx].offset < pos + kept.size()) {
+                    color = text_spans[span_idx].color;
+                    PushSpan(line_offset + text_spans[span_idx].offset - pos, color);
+
+                    span_idx += 1;
+                }
+            }
+
+            // Even if there's nothing to copy, so that empty lines end up in a chunk
+            char* dest = ReserveForLastLine(kept.size());
+
+            std::memcpy(dest, kept.data(), kept.size());
+
+            lines.back().len += kept.size();
+            chunks.back().size += kept.size();
+
+            if(newline == std::string_view::npos) {
+                break;
+            }
+
+            last_line_open = false;
+
+            text.remove_prefix(newline + 1);
+            pos += newline + 1;
+        }
+
+        EnforceMaxBytes();
+    }
+
+    void OutputBuffer::Clear() {
+        chunks.clear();
+        lines.clear();
+        spans.clear();
+
+        last_line_open = false;
+
+        byte_count = 0;
+        dropped_line_count = 0;
+        dropped_span_count = 0;
+    }
+
+    void OutputBuffer::SetMaxBytes(size_t max_bytes) {
+        this->max_bytes = max_bytes;
+        EnforceMaxBytes();
+    }
+
+    char* OutputBuffer::ReserveForLastLine(size_t len) {
+        auto& line = lines.back();
+
+        if(!chunks.empty()) {
+            auto& chunk = chunks.back();
+
+            if(chunk.size + len <= chunk.capacity) {
+                if(!line.data) {
+                    line.data = chunk.data.get() + chunk.size;
+                    chunk.line_count += 1;
+                }
+
+                return chunk.data.get() + chunk.size;
+            }
+
+            if(line.data) {
+                // This line is about to move into the new chunk below. The bytes it
+                // leaves behind are just dead space until the chunk is dropped.
+                chunk.line_count -= 1;
+            }
+        }
+
+        size_t needed = line.len + len;
+
+        // Long lines grow geometrically so appending to them isn't quadratic
+        size_t capacity = std::max({CHUNK_SIZE, needed, std::min(needed * 2, MaxLineLen())});
+
+        // Not using make_unique so that we don't zero the memory
+        Chunk new_chunk = {
+            .data = std::unique_ptr<char[]>{new char[capacity]},
+            .size = line.len,
+            .capacity = capacity,
+            .line_count = 1,
+        };
+
+        if(line.len > 0) {
+            std::memcpy(new_chunk.data.get(), line.data, line.len);
+        }
+
+        line.data = new_chunk.data.get();
+
+        // If the line was all that was in there, nothing refers to the old chunk anymore
+        if(!chunks.empty() && chunks.back().line_count == 0) {
+            byte_count -= chunks.back().capacity;
+            chunks.pop_back();
+        }
+
+        byte_count += capacity;
+        chunks.push_back(std::move(new_chunk));
+
+        return chunks.back().data.get() + chunks.back().size;
+    }
+
+    void OutputBuffer::PushSpan(size_t offset, uint32_t color) {
+        auto& line = lines.back();
+
+        // The last line's spans are always at the back
+        uint32_t cur_color = line.span_count > 0 ? spans.back().color : 0;
+
+        if(color == cur_color) {
+            return;
+        }
+
+        if(line.span_count > 0 && spans.back().offset == offset) {
+            spans.back().color = color;
+            return;
+        }
+
+        if(line.span_count == 0) {
+            line.first_span = dropped_span_count + spans.size();
+        }
+
+        spans.push_back({static_cast<uint32_t>(offset), color});
+        line.span_count += 1;
+    }
+
+    void OutputBuffer::EnforceMaxBytes() {
+        // We always keep the last chunk since that's where we're appending
+        while(byte_count > max_bytes && chunks.size() > 1) {
+            auto& chunk = chunks.front();
+
+            for(size_t i = 0; i < chunk.line_count; ++i) {
+                for(size_t j = 0; j < lines.front().span_count; ++j) {
+                    spans.pop_front();
+                }
+
+                dropped_span_count += lines.front().span_count;
+                lines.pop_front();
+            }
+
+            dropped_line_count += chunk.line_count;
+            byte_count -= chunk.capacity;
+
+            chunks.pop_front();
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <span>
+#include <string_view>
+
+#include "AnsiParser.hpp"
+
+namespace lodeb {
+    // Process output stored as a sequence of fixed-size chunks with an index
+    // of where each line starts, so that we can render only the visible lines
+    // no matter how much output there is.
+    //
+    // Once more than `max_bytes` are retained, whole chunks (and the lines in
+    // them) are dropped from the front.
+    //
+    // Lines longer than `MaxLineLen` are cut off, the rest of the line (up to the
+    // next newline) is thrown away.
+    //
+    // Lines can also carry color spans (see `AnsiParser`) which are stored
+    // separately from the text, with offsets relative to the start of the line.
+    class OutputBuffer {
+    public:
+        static constexpr size_t CHUNK_SIZE = 64 * 1024;
+        static constexpr size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+        explicit OutputBuffer(size_t max_bytes = DEFAULT_MAX_BYTES);
+
+        // `spans` are offsets into `text`, in ascending order
+        void Append(std::string_view text, std::span<const ColorSpan> spans = {});
+        void Clear();
+
+        // Number of retained lines (including a trailing partial line)
+        size_t LineCount() const { return lines.size(); }
+
+        // Lines which have seen their newline
+        size_t CompleteLineCount() const { return lines.size() - (last_line_open ? 1 : 0); }
+
+        // Excludes the newline
+        std::string_view Line(size_t idx) const {
+            auto& line = lines[idx];
+            return {line.data, line.len};
+        }
+
+        // Color changes within the line, empty if it's all the default color
+        size_t SpanCount(size_t idx) const { return lines[idx].span_count; }
+
+        ColorSpan Span(size_t idx, size_t span_idx) const {
+            return spans[lines[idx].first_span - dropped_span_count + span_idx];
+        }
+
+        // How many lines have been thrown away to stay under `max_bytes`
+        size_t DroppedLineCount() const { return dropped_line_count; }
+
+        // Memory held by the chunks
+        size_t ByteCount() const { return byte_count; }
+
+        size_t MaxBytes() const { return max_bytes; }
+
+        size_t MaxLineLen() const { return std::max(CHUNK_SIZE, max_bytes / 2); }
+        void SetMaxBytes(size_t max_bytes);
+
+    private:
+        struct Chunk {
+            std::unique_ptr<char[]> data;
+            size_t size = 0;
+            size_t capacity = 0;
+
+            // Number of entries in `lines` that start in this chunk
+            size_t line_count = 0;
+        };
+
+        struct LineRef {
+            const char* data = nullptr;
+            size_t len = 0;
+
+            // Counting from the very first span we were given, dropped or not
+            size_t first_span = 0;
+            size_t span_count = 0;
+        };
+
+        std::deque<Chunk> chunks;
+        std::deque<LineRef> lines;
+        std::deque<ColorSpan> spans;
+
+        // Whether the last line is still waiting for its newline
+        bool last_line_open = false;
+
+        size_t byte_count = 0;
+        size_t max_bytes = DEFAULT_MAX_BYTES;
+
+        size_t dropped_line_count = 0;
+        size_t dropped_span_count = 0;
+
+        // Makes room for `len` more contiguous bytes on the last line, moving
+        // it to a new chunk if it doesn't fit in the current one.
+        char* ReserveForLastLine(size_t len);
+
+        // Adds a span to the last line unless it wouldn't change the color
+        void PushSpan(size_t offset, uint32_t color);
+
+        void EnforceMaxBytes();
+    };
+}
@@ -0,0 +1,109 @@
+#include "OutputFilter.hpp"
+
+#include <algorithm>
+
+#include "Log.hpp"
+#include "TextSearch.hpp"
+
+namespace lodeb {
+    bool OutputFilter::SetPattern(std::string_view pattern, Mode mode) {
+        Reset();
+
+        if(pattern.empty()) {
+            return true;
+        }
+
+        auto new_matcher = std::make_shared<Matcher>();
+
+        new_matcher->mode = mode;
+        new_matcher->pattern = pattern;
+
+        if(mode == Mode::Regex) {
+            // std::regex only reports errors through exceptions
+            try {
+                new_matcher->regex.emplace(new_matcher->pattern, std::regex::ECMAScript | std::regex::optimize);
+            } catch(const std::regex_error& e) {
+                LogDebug("Invalid filter regex {}: {}", pattern, e.what());
+                return false;
+            }
+        }
+
+        matcher = std::move(new_matcher);
+
+        return true;
+    }
+
+    void OutputFilter::Reset() {
+        matcher.reset();
+        ClearMatches();
+    }
+
+    void OutputFilter::ClearMatches() {
+        generation += 1;
+
+        next_line = 0;
+        matches.clear();
+
+        // We don't wait on whatever's running, its result is just ignored once it comes in.
+        // The future has to stay alive until then though (its destructor would block).
+    }
+
+    void OutputFilter::CollectResults() {
+        if(!pending || pending->wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+            return;
+        }
+
+        auto result = pending->get();
+        pending.reset();
+
+        if(result.generation != generation) {
+            return;
+        }
+
+        matches.insert(matches.end(), result.matches.begin(), result.matches.end());
+    }
+
+    OutputFilter::Result OutputFilter::Match(std::shared_ptr<const Matcher> matcher, Batch batch) {
+        Result result = {
+            .generation = batch.generation,
+        };
+
+        auto& line_starts = batch.line_starts;
+
+        if(matcher->mode == Mode::Substring) {
+            std::vector<size_t> hits;
+            FindAllCaseInsensitive(batch.text, matcher->pattern, hits);
+
+            // Both are sorted so we can walk them together. The pattern can't contain a
+            // newline so a hit never spans lines.
+            size_t line_idx = 0;
+
+            for(auto hit : hits) {
+                while(line_idx + 1 < line_starts.size() && line_starts[line_idx + 1] <= hit) {
+                    line_idx += 1;
+                }
+
+                size_t line = batch.first_line + line_idx;
+
+                if(result.matches.empty() || result.matches.back() != line) {
+                    result.matches.push_back(line);
+                }
+            }
+
+            return result;
+        }
+
+        std::string_view text = batch.text;
+
+        for(size_t i = 0; i < line_starts.size(); ++i) {
+            size_t start = line_starts[i];
+            size_t end = (i + 1 < line_starts.size() ? line_starts[i + 1] : text.size()) - 1;
+
+            if(std::regex_search(text.begin() + start, text.begin() + end, *matcher->regex)) {
+                result.matches.push_back(batch.first_line + i);
+            }
+        }
+
+        return result;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <future>
+#include <memory>
+#include <optional>
+#include <regex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lodeb {
+    // Filters process output down to the lines matching a substring (case-insensitive)
+    // or regex. Matching happens on a worker and only ever looks at lines it hasn't
+    // seen yet, so new output just extends the match set.
+    //
+    // Lines are identified by their absolute line number since the last launch.
+    class OutputFilter {
+    public:
+        enum class Mode {
+            Substring,
+            Regex,
+        };
+
+        // Starts over with a new pattern. Returns false if the regex is invalid.
+        bool SetPattern(std::string_view pattern, Mode mode);
+
+        // Forgets all matches but keeps the pattern, matching starts over from the
+        // first line (e.g. when the output is cleared on relaunch)
+        void ClearMatches();
+
+        // Forgets all matches and the pattern
+        void Reset();
+
+        bool IsActive() const { return matcher != nullptr; }
+
+        // Picks up finished work and hands the next batch of lines in
+        // [first_line, end_line) to the worker. `get_line` maps an absolute
+        // line number to its text. Call once per frame.
+        template <typename GetLine>
+        void Update(size_t first_line, size_t end_line, GetLine&& get_line) {
+            if(!matcher) {
+                return;
+            }
+
+            CollectResults();
+
+            if(pending) {
+                return;
+            }
+
+            // Lines could've been dropped before we got to them
+            next_line = std::max(next_line, first_line);
+
+            if(next_line >= end_line) {
+                return;
+            }
+
+            Batch batch = {
+                .generation = generation,
+                .first_line = next_line,
+            };
+
+            for(; next_line < end_line && batch.text.size() < BATCH_BYTES; ++next_line) {
+                auto line = get_line(next_line);
+
+                batch.line_starts.push_back(batch.text.size());
+
+                batch.text.append(line);
+                batch.text.push_back('\n');
+            }
+
+            pending = std::async(std::launch::async, Match, matcher, std::move(batch));
+        }
+
+        // Sorted absolute line numbers
+        const std::vector<size_t>& Matches() const { return matches; }
+
+        // Whether there are lines we know about that haven't been matched yet
+        bool IsScanning() const { return pending.has_value(); }
+
+    private:
+        // Don't copy too much on the UI thread in one go
+        static constexpr size_t BATCH_BYTES = 8 * 1024 * 1024;
+
+        struct Matcher {
+            Mode mode = Mode::Substring;
+            std::string pattern;
+            std::optional<std::regex> regex;
+        };
+
+        struct Batch {
+            uint64_t generation = 0;
+            size_t first_line = 0;
+
+            // Lines joined by '\n'
+            std::string text;
+            std::vector<size_t> line_starts;
+        };
+
+        struct Result {
+            uint64_t generation = 0;
+            std::vector<size_t> matches;
+        };
+
+        std::shared_ptr<const Matcher> matcher;
+
+        // Bumped on every new pattern so that we ignore results for old ones
+        uint64_t generation = 0;
+
+        size_t next_line = 0;
+
+        std::optional<std::future<Result>> pending;
+
+        std::vector<size_t> matches;
+
+        void CollectResults();
+
+        static Result Match(std::shared_ptr<const Matcher> matcher, Batch batch);
+    };
+}
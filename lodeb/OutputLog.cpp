@@ -0,0 +1,231 @@
+#include "OutputLog.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "Log.hpp"
+
+namespace {
+    // Don't make a syscall for every little bit of output
+    constexpr size_t WRITE_BUF_FLUSH_SIZE = 64 * 1024;
+
+    // The map covers at least this much more than we need so that we don't remap every
+    // time the file grows. Past the end of the file it fills in as we write.
+    constexpr size_t MAP_STEP = 64 * 1024 * 1024;
+}
+
+namespace lodeb {
+    OutputLog::~OutputLog() {
+        Close();
+    }
+
+    bool OutputLog::Open(const std::filesystem::path& dir) {
+        Close();
+
+        // Unique name so nobody else can have put a file (or symlink) there first
+        std::string name = (dir / "lodeb-output-XXXXXX").string();
+
+        fd = mkostemp(name.data(), O_APPEND | O_CLOEXEC);
+
+        if(fd < 0) {
+            LogError("Failed to create output log in {}: {}", dir.string(), strerror(errno));
+            return false;
+        }
+
+        path = std::move(name);
+
+        sparse_index.push_back(0);
+
+        return true;
+    }
+
+    void OutputLog::Close() {
+        if(fd < 0) {
+            return;
+        }
+
+        Unmap();
+
+        close(fd);
+        fd = -1;
+
+        std::error_code ec_ignore;
+        std::filesystem::remove(path, ec_ignore);
+
+        path.clear();
+        write_buf.clear();
+
+        flushed_size = 0;
+        line_count = 0;
+        last_line_open = false;
+
+        sparse_index.clear();
+
+        cursor_line = 0;
+        cursor_offset = 0;
+    }
+
+    void OutputLog::Append(std::string_view text) {
+        if(fd < 0 || text.empty()) {
+            return;
+        }
+
+        size_t base = ByteCount();
+
+        for(size_t pos = 0; (pos = text.find('\n', pos)) != std::string_view::npos; pos += 1) {
+            line_count += 1;
+
+            if(line_count % INDEX_STRIDE == 0) {
+                sparse_index.push_back(base + pos + 1);
+            }
+        }
+
+        last_line_open = text.back() != '\n';
+
+        write_buf.append(text);
+
+        if(write_buf.size() >= WRITE_BUF_FLUSH_SIZE) {
+            Flush();
+        }
+    }
+
+    void OutputLog::Flush() {
+        if(fd < 0 || write_buf.empty()) {
+            return;
+        }
+
+        size_t written = 0;
+
+        while(written < write_buf.size()) {
+            auto n = write(fd, write_buf.data() + written, write_buf.size() - written);
+
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+
+                // The index already covers all of `write_buf`, so it no longer matches
+                // the file. Give up on the log, `State` falls back to what's in memory.
+                LogError("Failed to write output log {}, closing it: {}", path.string(), strerror(errno));
+                Close();
+                return;
+            }
+
+            written += static_cast<size_t>(n);
+        }
+
+        flushed_size += written;
+        write_buf.clear();
+    }
+
+    std::string_view OutputLog::Line(size_t idx) {
+        if(fd < 0 || idx >= LineCount()) {
+            return {};
+        }
+
+        Flush();
+
+        // Flushing can fail and close the log
+        if(fd < 0 || !EnsureMapped(flushed_size)) {
+            return {};
+        }
+
+        size_t start_line = (idx / INDEX_STRIDE) * INDEX_STRIDE;
+        size_t offset = sparse_index[idx / INDEX_STRIDE];
+
+        if(cursor_line <= idx && cursor_line > start_line) {
+            start_line = cursor_line;
+            offset = cursor_offset;
+        }
+
+        if(offset > flushed_size) {
+            return {};
+        }
+
+        const char* end = map + flushed_size;
+
+        for(; start_line < idx; ++start_line) {
+            auto* newline = static_cast<const char*>(std::memchr(map + offset, '\n', end - (map + offset)));
+
+            // Can only happen if a write failed partway through
+            if(!newline) {
+                return {};
+            }
+
+            offset = newline - map + 1;
+        }
+
+        auto* newline = static_cast<const char*>(std::memchr(map + offset, '\n', end - (map + offset)));
+        size_t line_end = newline ? static_cast<size_t>(newline - map) : flushed_size;
+
+        cursor_line = idx + 1;
+        cursor_offset = line_end + 1;
+
+        return {map + offset, line_end - offset};
+    }
+
+    bool OutputLog::Export(const std::filesystem::path& dest) {
+        if(fd < 0) {
+            return false;
+        }
+
+        Flush();
+
+        if(fd < 0) {
+            return false;
+        }
+
+        std::error_code ec;
+        std::filesystem::copy_file(path, dest, std::filesystem::copy_options::overwrite_existing, ec);
+
+        if(ec) {
+            LogError("Failed to export output log to {}: {}", dest.string(), ec.message());
+            return false;
+        }
+
+        return true;
+    }
+
+    bool OutputLog::EnsureMapped(size_t size) {
+        if(size == 0) {
+            return false;
+        }
+
+        if(map && map_size >= size) {
+            return true;
+        }
+
+        // The file only ever grows, so just map all of it again (and then some). We
+        // never touch the part past the end of the file, which would SIGBUS.
+        Unmap();
+
+        size = std::max(size * 2, (size + MAP_STEP - 1) / MAP_STEP * MAP_STEP);
+
+        void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+
+        if(ptr == MAP_FAILED) {
+            LogError("Failed to map output log {}: {}", path.string(), strerror(errno));
+            return false;
+        }
+
+        map = static_cast<const char*>(ptr);
+        map_size = size;
+
+        return true;
+    }
+
+    void OutputLog::Unmap() {
+        if(!map) {
+            return;
+        }
+
+        munmap(const_cast<char*>(map), map_size);
+
+        map = nullptr;
+        map_size = 0;
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lodeb {
+    // Append-only on-disk copy of everything the process printed, so that we can
+    // scroll back through output that `OutputBuffer` has already dropped.
+    //
+    // We keep the byte offset of every `INDEX_STRIDE`th line and read lines
+    // through an mmap of the file, so finding any line only means scanning
+    // forward at most `INDEX_STRIDE` lines no matter how big the log gets.
+    class OutputLog {
+    public:
+        static constexpr size_t INDEX_STRIDE = 256;
+
+        OutputLog() = default;
+        ~OutputLog();
+
+        OutputLog(const OutputLog&) = delete;
+        OutputLog& operator=(const OutputLog&) = delete;
+
+        // Creates a new file with a unique name in `dir`
+        bool Open(const std::filesystem::path& dir);
+
+        // Closes and deletes the file
+        void Close();
+
+        bool IsOpen() const { return fd >= 0; }
+
+        const std::filesystem::path& Path() const { return path; }
+
+        // Buffered, call `Flush` to make sure it hits the file. If a write fails the
+        // log is closed, since the line index would no longer match the file.
+        void Append(std::string_view text);
+        void Flush();
+
+        // Number of lines (including a trailing partial line)
+        size_t LineCount() const { return line_count + (last_line_open ? 1 : 0); }
+
+        size_t ByteCount() const { return flushed_size + write_buf.size(); }
+
+        // Excludes the newline. Only valid until the next call to `Line`, `Append` or `Flush`.
+        std::string_view Line(size_t idx);
+
+        // Copies the raw log to `dest`
+        bool Export(const std::filesystem::path& dest);
+
+    private:
+        std::filesystem::path path;
+        int fd = -1;
+
+        std::string write_buf;
+        size_t flushed_size = 0;
+
+        // Completed lines, i.e. newlines seen so far
+        size_t line_count = 0;
+        bool last_line_open = false;
+
+        // Byte offset of line `i * INDEX_STRIDE` is at `sparse_index[i]`
+        std::vector<uint64_t> sparse_index;
+
+        // Can be bigger than the file, only [0, flushed_size) is readable
+        const char* map = nullptr;
+        size_t map_size = 0;
+
+        // Where the last read line ended, so reading lines in order
+        // (like the clipper does) doesn't rescan from the index every time.
+        size_t cursor_line = 0;
+        size_t cursor_offset = 0;
+
+        // Remaps (in big steps) only if `size` is past the end of the map
+        bool EnsureMapped(size_t size);
+        void Unmap();
+    };
+}
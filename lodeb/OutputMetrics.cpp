@@ -0,0 +1,42 @@
+#include "OutputMetrics.hpp"
+
+#include <algorithm>
+
+namespace lodeb {
+    void OutputMetrics::Reset() {
+        *this = {};
+    }
+
+    void OutputMetrics::OnFrame(Clock::time_point now, size_t backlog) {
+        if(window_start == Clock::time_point{}) {
+            window_start = now;
+        }
+
+        auto elapsed = now - window_start;
+
+        if(elapsed >= WINDOW) {
+            double secs = std::chrono::duration<double>(elapsed).count();
+
+            bytes_per_sec = window_bytes / secs;
+            lines_per_sec = window_lines / secs;
+            max_backlog = window_max_backlog;
+            max_delay = window_max_delay;
+
+            window_start = now;
+            window_bytes = 0;
+            window_lines = 0;
+            window_max_backlog = 0;
+            window_max_delay = {};
+        }
+
+        this->backlog = backlog;
+        window_max_backlog = std::max(window_max_backlog, backlog);
+    }
+
+    void OutputMetrics::OnChunk(const OutputChunk& chunk, Clock::time_point now) {
+        window_bytes += chunk.text.size();
+        window_lines += std::count(chunk.text.begin(), chunk.text.end(), '\n');
+
+        window_max_delay = std::max(window_max_delay, now - chunk.read_at);
+    }
+}
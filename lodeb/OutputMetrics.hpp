@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+#include "ProcessOutputReader.hpp"
+
+namespace lodeb {
+    // Throughput and latency of process output as it makes its way from the reader
+    // thread to the UI, so we can tell whether we're the bottleneck when output
+    // feels slow.
+    //
+    // Everything is accumulated over one second windows and published at the end
+    // of each, so the numbers are stable enough to read.
+    class OutputMetrics {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void Reset();
+
+        // Call with the number of chunks queued up by the reader, before draining them
+        void OnFrame(Clock::time_point now, size_t backlog);
+
+        // Call for every chunk as it's spliced into the output, `now` being the same
+        // as what was passed to `OnFrame`.
+        void OnChunk(const OutputChunk& chunk, Clock::time_point now);
+
+        double BytesPerSec() const { return bytes_per_sec; }
+        double LinesPerSec() const { return lines_per_sec; }
+
+        // Chunks waiting in the reader's queue at the start of this frame
+        size_t Backlog() const { return backlog; }
+
+        // Worst case over the last window
+        size_t MaxBacklog() const { return max_backlog; }
+
+        // Worst case over the last window, from the reader pulling output out of the
+        // process to the UI thread picking it up (it's rendered that same frame).
+        Clock::duration MaxDelay() const { return max_delay; }
+
+    private:
+        static constexpr auto WINDOW = std::chrono::seconds(1);
+
+        // Published
+        double bytes_per_sec = 0;
+        double lines_per_sec = 0;
+        size_t backlog = 0;
+        size_t max_backlog = 0;
+        Clock::duration max_delay = {};
+
+        // Current window
+        Clock::time_point window_start;
+        size_t window_bytes = 0;
+        size_t window_lines = 0;
+        size_t window_max_backlog = 0;
+        Clock::duration window_max_delay = {};
+    };
+}
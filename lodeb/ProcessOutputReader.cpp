@@ -0,0 +1,165 @@
+#include "ProcessOutputReader.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include "Log.hpp"
+
+namespace {
+    constexpr size_t READ_BUF_SIZE = 16 * 1024;
+}
+
+namespace lodeb {
+    ProcessOutputReader::ProcessOutputReader(lldb::SBProcess process, Pty pty):
+        process{process},
+        listener{"lodeb.process_output"},
+        pty{std::move(pty)} {
+        // This is in addition to the listener the process was launched with, which
+        // still gets all of these events too.
+        listener.StartListeningForEvents(
+            process.GetBroadcaster(),
+            lldb::SBProcess::eBroadcastBitSTDOUT |
+            lldb::SBProcess::eBroadcastBitSTDERR |
+            lldb::SBProcess::eBroadcastBitStateChanged
+        );
+
+        thread = std::thread{[this] { Run(); }};
+    }
+
+    ProcessOutputReader::~ProcessOutputReader() {
+        Stop([](OutputChunk&) {});
+    }
+
+    void ProcessOutputReader::Write(std::string_view text) {
+        if(!pty.IsOpen()) {
+            process.PutSTDIN(text.data(), text.size());
+            return;
+        }
+
+        while(!text.empty()) {
+            auto n = write(pty.MasterFd(), text.data(), text.size());
+
+            if(n < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+
+                // The master is non-blocking, so if the inferior isn't reading its
+                // input we'd rather drop keystrokes than hang the UI.
+                LogError("Failed to write to pty: {}", strerror(errno));
+                break;
+            }
+
+            text.remove_prefix(static_cast<size_t>(n));
+        }
+    }
+
+    void ProcessOutputReader::Run() {
+        lldb::SBEvent event;
+
+        auto is_exit_event = [&] {
+            auto state = lldb::SBProcess::GetStateFromEvent(event);
+
+            return state == lldb::eStateExited ||
+                   state == lldb::eStateDetached ||
+                   state == lldb::eStateUnloaded;
+        };
+
+        for(;;) {
+            bool exited = false;
+
+            if(pty.IsOpen()) {
+                // The output doesn't go through LLDB at all, so we wait on the pty itself
+                // and just check for state changes in between.
+                pollfd pfd = {
+                    .fd = pty.MasterFd(),
+                    .events = POLLIN,
+                };
+
+                poll(&pfd, 1, 100);
+
+                while(listener.GetNextEvent(event)) {
+                    exited |= is_exit_event();
+                }
+
+                DrainPty();
+            } else {
+                // Time out once in a while so we notice `stop_requested`
+                if(listener.WaitForEvent(1, event)) {
+                    exited = is_exit_event();
+                }
+
+                // We drain regardless of the kind of event, since a state change
+                // (e.g. exiting) can come right after the last bit of output.
+                DrainPipe(OutputStream::Stdout);
+                DrainPipe(OutputStream::Stderr);
+            }
+
+            if(exited || stop_requested) {
+                break;
+            }
+        }
+
+        finished = true;
+    }
+
+    void ProcessOutputReader::DrainPipe(OutputStream stream) {
+        char buf[READ_BUF_SIZE];
+
+        for(;;) {
+            size_t n = stream == OutputStream::Stdout ?
+                process.GetSTDOUT(buf, sizeof(buf)) :
+                process.GetSTDERR(buf, sizeof(buf));
+
+            if(n == 0) {
+                break;
+            }
+
+            Push(stream, {buf, n});
+        }
+    }
+
+    void ProcessOutputReader::DrainPty() {
+        char buf[READ_BUF_SIZE];
+
+        for(;;) {
+            auto n = read(pty.MasterFd(), buf, sizeof(buf));
+
+            if(n < 0 && errno == EINTR) {
+                continue;
+            }
+
+            // EAGAIN means we've read everything for now, EIO means nobody has the
+            // other side open anymore.
+            if(n <= 0) {
+                break;
+            }
+
+            Push(OutputStream::Stdout, {buf, static_cast<size_t>(n)});
+        }
+    }
+
+    void ProcessOutputReader::Push(OutputStream stream, std::string_view data) {
+        OutputChunk chunk = {
+            .stream = stream,
+            .read_at = std::chrono::steady_clock::now(),
+        };
+
+        // Parse here rather than on the UI thread so that rendering is just a
+        // matter of walking the spans.
+        auto& parser = stream == OutputStream::Stdout ? stdout_parser : stderr_parser;
+        parser.Parse(data, chunk.text, chunk.spans);
+
+        if(chunk.text.empty()) {
+            return;
+        }
+
+        // Back off if the UI thread is falling behind rather than dropping output
+        while(!queue.TryPush(chunk)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "AnsiParser.hpp"
+#include "Pty.hpp"
+#include "SpscQueue.hpp"
+
+namespace lodeb {
+    enum class OutputStream {
+        Stdout,
+        Stderr,
+    };
+
+    struct OutputChunk {
+        OutputStream stream = OutputStream::Stdout;
+
+        // When the reader pulled this out of the process
+        std::chrono::steady_clock::time_point read_at;
+
+        // Escape sequences have already been stripped out of this
+        std::string text;
+
+        // Colors from the escape sequences, offsets are into `text`
+        std::vector<ColorSpan> spans;
+    };
+
+    // Drains the inferior's stdout/stderr on a dedicated thread as soon as LLDB
+    // broadcasts that there's output, and hands it to the UI thread through a
+    // lock-free queue. The UI just splices in whatever is available each frame.
+    //
+    // If the process was launched on a `Pty` we read from that instead of the
+    // pipes LLDB gives us. Everything comes through as `Stdout` in that case.
+    class ProcessOutputReader {
+    public:
+        explicit ProcessOutputReader(lldb::SBProcess process, Pty pty = {});
+        ~ProcessOutputReader();
+
+        ProcessOutputReader(const ProcessOutputReader&) = delete;
+        ProcessOutputReader& operator=(const ProcessOutputReader&) = delete;
+
+        // Call from the UI thread only
+        template <typename Fn>
+        void Drain(Fn&& fn) {
+            OutputChunk chunk;
+
+            while(queue.TryPop(chunk)) {
+                fn(chunk);
+            }
+        }
+
+        // Chunks read but not yet drained
+        size_t QueuedChunkCount() const { return queue.SizeApprox(); }
+
+        // Sends `text` to the process's stdin. Call from the UI thread only.
+        void Write(std::string_view text);
+
+        // Stops the reader after it has read everything the process wrote. Output
+        // which is still queued is passed to `fn` (call from the UI thread only).
+        template <typename Fn>
+        void Stop(Fn&& fn) {
+            stop_requested = true;
+
+            // The reader could be blocked on a full queue so we have to keep draining
+            while(!finished) {
+                Drain(fn);
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            if(thread.joinable()) {
+                thread.join();
+            }
+
+            Drain(fn);
+        }
+
+    private:
+        static constexpr size_t QUEUE_CAPACITY = 4096;
+
+        lldb::SBProcess process;
+        lldb::SBListener listener;
+
+        Pty pty;
+
+        SpscQueue<OutputChunk, QUEUE_CAPACITY> queue;
+
+        std::atomic<bool> stop_requested = false;
+        std::atomic<bool> finished = false;
+
+        std::thread thread;
+
+        // Only touched by the reader thread
+        AnsiParser stdout_parser;
+        AnsiParser stderr_parser;
+
+        void Run();
+        void DrainPipe(OutputStream stream);
+        void DrainPty();
+
+        void Push(OutputStream stream, std::string_view data);
+    };
+}
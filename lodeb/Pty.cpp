@@ -0,0 +1,92 @@
+#include "Pty.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "Log.hpp"
+
+namespace lodeb {
+    Pty::~Pty() {
+        Close();
+    }
+
+    Pty::Pty(Pty&& other) noexcept:
+        master_fd{std::exchange(other.master_fd, -1)},
+        secondary_fd{std::exchange(other.secondary_fd, -1)},
+        secondary_path{std::move(other.secondary_path)} {}
+
+    Pty& Pty::operator=(Pty&& other) noexcept {
+        if(this != &other) {
+            Close();
+
+            master_fd = std::exchange(other.master_fd, -1);
+            secondary_fd = std::exchange(other.secondary_fd, -1);
+            secondary_path = std::move(other.secondary_path);
+        }
+
+        return *this;
+    }
+
+    bool Pty::Open() {
+        Close();
+
+        // Neither end should leak into whatever LLDB forks, the inferior opens the
+        // secondary by path and has no business holding on to the master.
+        master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+        if(master_fd < 0) {
+            LogError("Failed to open pty: {}", strerror(errno));
+            return false;
+        }
+
+        const char* name = nullptr;
+
+        if(grantpt(master_fd) != 0 || unlockpt(master_fd) != 0 || !(name = ptsname(master_fd))) {
+            LogError("Failed to set up pty: {}", strerror(errno));
+
+            Close();
+            return false;
+        }
+
+        secondary_path = name;
+        secondary_fd = open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+
+        if(secondary_fd < 0) {
+            LogError("Failed to open {}: {}", secondary_path, strerror(errno));
+
+            Close();
+            return false;
+        }
+
+        // Otherwise every "\n" the inferior writes comes out as "\r\n"
+        termios attrs = {};
+
+        if(tcgetattr(secondary_fd, &attrs) == 0) {
+            attrs.c_oflag &= ~ONLCR;
+            tcsetattr(secondary_fd, TCSANOW, &attrs);
+        }
+
+        fcntl(master_fd, F_SETFL, fcntl(master_fd, F_GETFL) | O_NONBLOCK);
+
+        return true;
+    }
+
+    void Pty::Close() {
+        if(secondary_fd >= 0) {
+            close(secondary_fd);
+            secondary_fd = -1;
+        }
+
+        if(master_fd >= 0) {
+            close(master_fd);
+            master_fd = -1;
+        }
+
+        secondary_path.clear();
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+
+namespace lodeb {
+    // A pseudo-terminal we launch the inferior on, so that it sees a tty and
+    // line buffers its output instead of fully buffering it like it would for
+    // a pipe.
+    class Pty {
+    public:
+        Pty() = default;
+        ~Pty();
+
+        Pty(Pty&& other) noexcept;
+        Pty& operator=(Pty&& other) noexcept;
+
+        Pty(const Pty&) = delete;
+        Pty& operator=(const Pty&) = delete;
+
+        bool Open();
+        void Close();
+
+        bool IsOpen() const { return master_fd >= 0; }
+
+        // Non-blocking, this is what we read output from and write input to
+        int MasterFd() const { return master_fd; }
+
+        // Pass this to the inferior for its stdin/stdout/stderr
+        const std::string& SecondaryPath() const { return secondary_path; }
+
+    private:
+        int master_fd = -1;
+
+        // We hold the secondary side open ourselves so that the master doesn't
+        // report a hangup before the inferior has opened it (or if it closes
+        // its stdout early). We find out about exits from LLDB anyway.
+        int secondary_fd = -1;
+
+        std::string secondary_path;
+    };
+}
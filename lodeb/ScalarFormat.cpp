@@ -0,0 +1,142 @@
+#include "ScalarFormat.hpp"
+
+#include <cstring>
+#include <format>
+
+namespace {
+    template <typename T>
+    T Load(const uint8_t* bytes) {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+
+        return value;
+    }
+}
+
+namespace lodeb {
+    std::optional<ScalarFormat> ScalarFormat::ForType(lldb::SBType type) {
+        type = type.GetCanonicalType();
+
+        auto size = static_cast<uint32_t>(type.GetByteSize());
+
+        if(type.IsPointerType()) {
+            return ScalarFormat{.kind = Pointer, .size = size};
+        }
+
+        Kind kind;
+
+        switch(type.GetBasicType()) {
+            case lldb::eBasicTypeBool:
+                kind = Bool;
+                break;
+
+            case lldb::eBasicTypeChar:
+            case lldb::eBasicTypeSignedChar:
+                kind = Char;
+                break;
+
+            case lldb::eBasicTypeUnsignedChar:
+            case lldb::eBasicTypeChar8:
+                kind = UnsignedChar;
+                break;
+
+            case lldb::eBasicTypeShort:
+            case lldb::eBasicTypeInt:
+            case lldb::eBasicTypeLong:
+            case lldb::eBasicTypeLongLong:
+            case lldb::eBasicTypeWChar:
+            case lldb::eBasicTypeSignedWChar:
+                kind = Signed;
+                break;
+
+            case lldb::eBasicTypeUnsignedShort:
+            case lldb::eBasicTypeUnsignedInt:
+            case lldb::eBasicTypeUnsignedLong:
+            case lldb::eBasicTypeUnsignedLongLong:
+            case lldb::eBasicTypeUnsignedWChar:
+            case lldb::eBasicTypeChar16:
+            case lldb::eBasicTypeChar32:
+                kind = Unsigned;
+                break;
+
+            case lldb::eBasicTypeFloat:
+            case lldb::eBasicTypeDouble:
+                kind = Float;
+                break;
+
+            default:
+                return std::nullopt;
+        }
+
+        if(size != 1 && size != 2 && size != 4 && size != 8) {
+            return std::nullopt;
+        }
+
+        if(kind == Float && size != 4 && size != 8) {
+            return std::nullopt;
+        }
+
+        return ScalarFormat{.kind = kind, .size = size};
+    }
+
+    void ScalarFormat::Format(const uint8_t* bytes, std::string& out) const {
+        auto it = std::back_inserter(out);
+
+        auto load_signed = [&]() -> int64_t {
+            switch(size) {
+                case 1: return Load<int8_t>(bytes);
+                case 2: return Load<int16_t>(bytes);
+                case 4: return Load<int32_t>(bytes);
+                default: return Load<int64_t>(bytes);
+            }
+        };
+
+        auto load_unsigned = [&]() -> uint64_t {
+            switch(size) {
+                case 1: return Load<uint8_t>(bytes);
+                case 2: return Load<uint16_t>(bytes);
+                case 4: return Load<uint32_t>(bytes);
+                default: return Load<uint64_t>(bytes);
+            }
+        };
+
+        switch(kind) {
+            case Bool:
+                out += load_unsigned() ? "true" : "false";
+                break;
+
+            case Char:
+            case UnsignedChar: {
+                // Same as LLDB, e.g. 97 'a'
+                auto c = static_cast<char>(bytes[0]);
+                int num = kind == Char ? static_cast<int>(c) : static_cast<int>(bytes[0]);
+
+                if(c >= 0x20 && c < 0x7F) {
+                    std::format_to(it, "{} '{}'", num, c);
+                } else {
+                    std::format_to(it, "{}", num);
+                }
+            } break;
+
+            case Signed:
+                std::format_to(it, "{}", load_signed());
+                break;
+
+            case Unsigned:
+                std::format_to(it, "{}", load_unsigned());
+                break;
+
+            case Float:
+                if(size == 4) {
+                    std::format_to(it, "{}", Load<float>(bytes));
+                } else {
+                    std::format_to(it, "{}", Load<double>(bytes));
+                }
+                break;
+
+            case Pointer:
+                std::format_to(it, "{:#0{}x}", load_unsigned(), size * 2 + 2);
+                break;
+        }
+    }
+}
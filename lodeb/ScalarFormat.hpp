@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include <lldb/API/LLDB.h>
+
+namespace lodeb {
+    // How to turn the raw bytes of a scalar into text ourselves, so that we can
+    // read lots of them in one go instead of creating an `SBValue` for each.
+    struct ScalarFormat {
+        enum Kind {
+            Bool,
+            Char,
+            UnsignedChar,
+            Signed,
+            Unsigned,
+            Float,
+            Pointer,
+        };
+
+        Kind kind = Signed;
+        uint32_t size = 0;
+
+        // Empty if it's not a type we can decode (e.g. a struct)
+        static std::optional<ScalarFormat> ForType(lldb::SBType type);
+
+        // `bytes` must hold `size` bytes in the target's byte order, which we assume
+        // is the same as ours.
+        void Format(const uint8_t* bytes, std::string& out) const;
+    };
+}
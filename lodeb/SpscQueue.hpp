@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace lodeb {
+    // Lock-free bounded queue for exactly one producer thread and one consumer thread.
+    template <typename T, size_t Capacity>
+    class SpscQueue {
+        static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+    public:
+        // Only moves from `item` if there was room
+        bool TryPush(T& item) {
+            auto tail = write_index.load(std::memory_order_relaxed);
+
+            if(tail - read_index.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+
+            slots[tail & (Capacity - 1)] = std::move(item);
+            write_index.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool TryPop(T& item) {
+            auto head = read_index.load(std::memory_order_relaxed);
+
+            if(head == write_index.load(std::memory_order_acquire)) {
+                return false;
+            }
+
+            item = std::move(slots[head & (Capacity - 1)]);
+            read_index.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Only exact when called from the producer or consumer while the other is idle
+        size_t SizeApprox() const {
+            return write_index.load(std::memory_order_acquire) - read_index.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::array<T, Capacity> slots;
+
+        // Kept on separate cache lines so the two threads don't fight over them
+        alignas(64) std::atomic<size_t> read_index = 0;
+        alignas(64) std::atomic<size_t> write_index = 0;
+    };
+}
@@ -2,6 +2,8 @@
 
 #include <fstream>
 #include <cassert>
+#include <charconv>
+#include <chrono>
 #include <future>
 
 #include <lldb/API/LLDB.h>
@@ -50,9 +52,45 @@ namespace lodeb {
                 file >> std::ws >> std::quoted(target_settings.working_dir);
             }
 
+            if(buf == "process_output.max_bytes") {
+                size_t max_bytes = 0;
+                file >> max_bytes;
+
+                process_output.SetMaxBytes(max_bytes);
+            }
+
+            if(buf == "process_output.spill_to_disk") {
+                file >> spill_process_output;
+            }
+
+            if(buf == "process_output.launch_in_pty") {
+                file >> launch_in_pty;
+            }
+
             if(buf == "source_view_state.path") {
                 file >> std::ws >> std::quoted(init(source_view_state)->path);
             }
+
+            if(buf == "string_formatter") {
+                StringLayout layout;
+                std::string len_field, encoding;
+
+                file >> std::ws >> std::quoted(layout.type_pattern) >> layout.ptr_field >> len_field >> encoding;
+
+                if(len_field != "-") {
+                    layout.len_field = std::move(len_field);
+                }
+
+                if(encoding == "utf16") {
+                    layout.encoding = StringLayout::Utf16;
+                } else if(encoding == "utf32") {
+                    layout.encoding = StringLayout::Utf32;
+                } else if(encoding != "utf8") {
+                    LogError("Unknown string_formatter encoding {}, assuming utf8", encoding);
+                }
+
+                value_formatters.AddStringLayout(std::move(layout));
+            }
         }
 
         if(!target_settings.exe_path.empty()) {
@@ -70,9 +108,21 @@ namespace lodeb {
         file << "target_settings.exe_path " << std::quoted(target_settings.exe_path) << '\n';
         file << "target_settings.working_dir " << std::quoted(target_settings.working_dir) << '\n';
 
+        file << "process_output.max_bytes " << process_output.MaxBytes() << '\n';
+        file << "process_output.spill_to_disk " << spill_process_output << '\n';
+        file << "process_output.launch_in_pty " << launch_in_pty << '\n';
+
         if(source_view_state) {
             file << "source_view_state.path " << std::quoted(source_view_state->path) << '\n';
         }
+
+        for(auto& layout : value_formatters.StringLayouts()) {
+            const char* encoding = layout.encoding == StringLayout::Utf16 ? "utf16" :
+                                   layout.encoding == StringLayout::Utf32 ? "utf32" : "utf8";
+
+            file << "string_formatter " << std::quoted(layout.type_pattern) << ' ' << layout.ptr_field << ' '
+                 << (layout.len_field.empty() ? "-" : layout.len_field) << ' ' << encoding << '\n';
+        }
     }
 
     void State::Update() {
@@ -85,22 +135,23 @@ namespace lodeb {
 
             auto& ps = *target_state->process_state;
 
-            // Poll the output
-            char buf[2048] = {0};
+            memory_cache.Sync(ps.process);
 
-            size_t n = ps.process.GetSTDOUT(buf, sizeof(buf) - 1);
-            if(n >= 0) {
-                buf[n] = '\0';
-            }
+            auto now = std::chrono::steady_clock::now();
 
-            process_output += buf;
+            process_output_metrics.OnFrame(now, ps.output_reader->QueuedChunkCount());
 
-            n = ps.process.GetSTDERR(buf, sizeof(buf) - 1);
-            if(n >= 0) {
-                buf[n] = '\0';
-            }
+            auto append_output = [&](OutputChunk& chunk) {
+                process_output_metrics.OnChunk(chunk, now);
+                process_output.Append(chunk.text, chunk.spans);
+
+                // The log only has the plain text, so lines that have been dropped
+                // from memory lose their color.
+                process_output_log.Append(chunk.text);
+            };
 
-            process_output += buf;
+            // Splice in whatever the reader thread has picked up since last frame
+            ps.output_reader->Drain(append_output);
 
             // Listen for process events
             lldb::SBEvent process_event;
@@ -108,14 +159,19 @@ namespace lodeb {
             while(ps.listener.GetNextEvent(process_event)) {
                 auto state = lldb::SBProcess::GetStateFromEvent(process_event);
 
+                if(state != lldb::eStateInvalid) {
+                    ps.state = state;
+                }
+
                 if(state == lldb::eStateStopped) {
                     LogInfo("Process stopped");
 
-                    // Select the thread which was stopped due to breakpoint/step
+                    // Select the thread which was stopped due to breakpoint/watchpoint/step
                     for(auto i = 0u; i < ps.process.GetNumThreads(); ++i) {
                         auto t = ps.process.GetThreadAtIndex(i);
 
                         if(t.GetStopReason() == lldb::eStopReasonBreakpoint ||
+                           t.GetStopReason() == lldb::eStopReasonWatchpoint ||
                            t.GetStopReason() == lldb::eStopReasonPlanComplete) {
                             ps.process.SetSelectedThread(t);
 
@@ -132,11 +188,18 @@ namespace lodeb {
                         }
                     }
 
+                    // The event arrives before we see the new stop ID
+                    memory_cache.Sync(ps.process);
+                    target_state->watchpoints.Update(ps.process.GetStopID(), memory_cache);
+
                     // Recompute watched values
                     ComputeWatchedValues();
                 } else if(state == lldb::eStateExited || state == lldb::eStateDetached || state == lldb::eStateUnloaded) {
                     LogInfo("Process exited");
 
+                    // Make sure we get everything the process wrote before it exited
+                    ps.output_reader->Stop(append_output);
+
                     // All done, stop
                     target_state->process_state.reset();
                     return;
@@ -188,6 +251,21 @@ namespace lodeb {
 
         handle_process();
 
+        if(target_state) {
+            lldb::SBEvent target_event;
+
+            while(target_state->target_listener.GetNextEvent(target_event)) {
+                if(target_event.GetType() & lldb::SBTarget::eBroadcastBitModulesLoaded) {
+                    target_state->breakable_lines.OnModulesLoaded();
+                } else {
+                    // We don't care what changed, just that we need to rebuild the index
+                    target_state->bp_line_index_dirty = true;
+                }
+            }
+
+            target_state->breakable_lines.Update();
+        }
+
         for(const auto& event : events) {
             if(auto* load_target = std::get_if<LoadTargetEvent>(&event)) {
                 LogDebug("Kicking off task to load target {}", target_settings.exe_path);
@@ -203,9 +281,18 @@ namespace lodeb {
                     // Disabled by default
                     breakpoint_on_throw.SetEnabled(false);
 
+                    lldb::SBListener target_listener{"lodeb.target"};
+
+                    target_listener.StartListeningForEvents(
+                        target.GetBroadcaster(),
+                        lldb::SBTarget::eBroadcastBitBreakpointChanged |
+                        lldb::SBTarget::eBroadcastBitModulesLoaded
+                    );
+
                     TargetState ts = {
                         .target = std::move(target),
                         .breakpoint_on_throw = std::move(breakpoint_on_throw),
+                        .target_listener = std::move(target_listener),
                     };
 
                     LogInfo("Created target {}", exe_path);
@@ -218,6 +305,13 @@ namespace lodeb {
                 if(source_view_state && source_view_state->path == view_source->loc.path) {
                     source_view_state->scroll_to_line = view_source->loc.line;
                 } else {
+                    if(source_view_state) {
+                        // A search of a big file could still be scanning the old text, which the
+                        // assignment below would free before it gets to `search`. Resetting the
+                        // search waits on it.
+                        source_view_state->search.reset();
+                    }
+
                     source_view_state = {
                         // We shant access the loc path again since we're clearing out these events
                         .path = std::move(view_source->loc.path),
@@ -226,7 +320,17 @@ namespace lodeb {
                 }
             } else if(auto* start_process = std::get_if<StartProcessEvent>(&event)) {
                 assert(target_state);
-                process_output.clear();
+                process_output.Clear();
+                // The filter still applies to the new output
+                process_output_filter.ClearMatches();
+                process_output_metrics.Reset();
+
+                if(spill_process_output) {
+                    // A new log on every launch, just like `process_output` is cleared
+                    process_output_log.Open(std::filesystem::temp_directory_path());
+                } else {
+                    process_output_log.Close();
+                }
 
                 auto listener = debugger.GetListener();
 
@@ -235,6 +339,17 @@ namespace lodeb {
                 li.SetWorkingDirectory(target_settings.working_dir.c_str());
                 li.SetListener(listener);
 
+                Pty pty;
+
+                // We just fall back to pipes if this fails
+                if(launch_in_pty && pty.Open()) {
+                    auto* path = pty.SecondaryPath().c_str();
+
+                    li.AddOpenFileAction(STDIN_FILENO, path, true, false);
+                    li.AddOpenFileAction(STDOUT_FILENO, path, false, true);
+                    li.AddOpenFileAction(STDERR_FILENO, path, false, true);
+                }
+
                 lldb::SBError err;
 
                 auto process = target_state->target.Launch(li, err);
@@ -246,9 +361,12 @@ namespace lodeb {
 
                 LogInfo("Started process {}", target_settings.exe_path);
 
+                auto output_reader = std::make_unique<ProcessOutputReader>(process, std::move(pty));
+
                 target_state->process_state = {
                     .listener = std::move(listener),
                     .process = std::move(process),
+                    .output_reader = std::move(output_reader),
                 };
             } else if(auto* toggle_bp = std::get_if<ToggleBreakpointEvent>(&event)) {
                 assert(target_state);
@@ -264,6 +382,7 @@ namespace lodeb {
                     );
 
                     target_state->loc_to_breakpoint[toggle_bp->loc] = std::move(bp);
+                    target_state->bp_line_index_dirty = true;
                     continue;
                 }
 
@@ -272,6 +391,7 @@ namespace lodeb {
                 LogDebug("Removing breakpoint from {}", toggle_bp->loc);
 
                 target_state->loc_to_breakpoint.erase(found);
+                target_state->bp_line_index_dirty = true;
             } else if (auto* change_state = std::get_if<ChangeDebugStateEvent>(&event)) {
                 assert(target_state);
                 assert(target_state->process_state);
@@ -280,7 +400,11 @@ namespace lodeb {
 
                 auto& ps = *target_state->process_state;
 
-                assert(ps.process.GetState() == lldb::eStateStopped);
+                assert(ps.IsStopped());
+
+                // Whatever these were doing is about to be out of date
+                locals_tree.Cancel();
+                watch_state.evaluator.Cancel();
 
                 auto thread = ps.process.GetSelectedThread();
 
@@ -290,6 +414,191 @@ namespace lodeb {
                     case ChangeDebugStateEvent::StepOver: thread.StepOver(); break;
                     case ChangeDebugStateEvent::Continue: ps.process.Continue(); break;
                 }
+
+                // Don't wait for the event to stop treating it as stopped
+                ps.state = lldb::eStateRunning;
+            } else if(auto* write_stdin = std::get_if<WriteStdinEvent>(&event)) {
+                if(!target_state || !target_state->process_state) {
+                    continue;
+                }
+
+                target_state->process_state->output_reader->Write(write_stdin->text);
+            } else if(auto* view_memory = std::get_if<ViewMemoryEvent>(&event)) {
+                auto& mvs = memory_view_state;
+
+                mvs.addr.reset();
+                mvs.error.clear();
+
+                std::string_view expr = view_memory->expr;
+
+                // Plain addresses don't need a frame
+                int base = 10;
+
+                if(expr.starts_with("0x") || expr.starts_with("0X")) {
+                    expr.remove_prefix(2);
+                    base = 16;
+                }
+
+                lldb::addr_t addr = 0;
+                auto [end, ec] = std::from_chars(expr.data(), expr.data() + expr.size(), addr, base);
+
+                if(ec == std::errc{} && end == expr.data() + expr.size()) {
+                    mvs.addr = addr;
+                    continue;
+                }
+
+                auto frame = GetCurFrame();
+
+                if(!frame) {
+                    mvs.error = "Process is not stopped";
+                    continue;
+                }
+
+                // Same limits as the watch evaluator so a call into the inferior can't hang
+                // the UI, and plain variable paths don't go through the JIT at all
+                auto opts = WatchEvaluator::Options();
+                auto value = EvaluateWatchExpr(*frame, view_memory->expr.c_str(), ClassifyWatchExpr(view_memory->expr), opts);
+
+                if(value.GetError().Fail()) {
+                    auto* err = value.GetError().GetCString();
+                    mvs.error = err ? err : "Failed to evaluate expression";
+
+                    continue;
+                }
+
+                auto type = value.GetType().GetCanonicalType();
+
+                // Pointers (and things like integers) are the address, otherwise show the object itself
+                if(type.IsPointerType() || type.GetBasicType() != lldb::eBasicTypeInvalid) {
+                    mvs.addr = value.GetValueAsUnsigned();
+                } else if(auto load_addr = value.GetLoadAddress(); load_addr != LLDB_INVALID_ADDRESS) {
+                    mvs.addr = load_addr;
+                } else {
+                    mvs.error = "Expression has no address";
+                }
+            } else if(auto* benchmark = std::get_if<BenchmarkWatchEvent>(&event)) {
+                auto frame = GetCurFrame();
+
+                if(!frame || benchmark->index >= watch_state.expr_values.size()) {
+                    continue;
+                }
+
+                auto& watch = watch_state.expr_values[benchmark->index];
+
+                if(watch.pending || !watch.result.IsValid()) {
+                    watch.benchmark = "Not evaluated at this stop yet";
+                    continue;
+                }
+
+                // Reuse what the evaluator produced rather than running the expression
+                // again on the UI thread with none of its limits
+                auto value = watch.result;
+                auto addr = value.GetLoadAddress();
+
+                if(addr == LLDB_INVALID_ADDRESS) {
+                    watch.benchmark = "Not in memory, nothing to compare";
+                    continue;
+                }
+
+                // Both sides format the same number of elements
+                uint32_t elem_count = std::min<uint32_t>(value.GetNumChildren(), ValueFormatters::MAX_ELEMENTS);
+
+                // LLDB caches children on the value object, so each pass gets a fresh one
+                // over the same memory. That leaves process memory as the only thing
+                // reused, and both sides get one untimed pass to warm it up.
+                auto format_lldb = [&] {
+                    auto fresh = value.CreateValueFromAddress(watch.expr.c_str(), addr, value.GetType());
+
+                    std::string out;
+
+                    if(const char* summary = fresh.GetSummary()) {
+                        out += summary;
+                    }
+
+                    for(uint32_t i = 0; i < elem_count; ++i) {
+                        auto child = fresh.GetChildAtIndex(i);
+
+                        if(const char* str = child.GetValue()) {
+                            out += str;
+                        } else if(const char* str = child.GetSummary()) {
+                            out += str;
+                        }
+                    }
+
+                    return out;
+                };
+
+                value_formatters.Format(value, memory_cache);
+                format_lldb();
+
+                using Millis = std::chrono::duration<double, std::milli>;
+
+                auto start = std::chrono::steady_clock::now();
+                auto formatted = value_formatters.Format(value, memory_cache);
+                Millis native_time = std::chrono::steady_clock::now() - start;
+
+                start = std::chrono::steady_clock::now();
+                format_lldb();
+                Millis lldb_time = std::chrono::steady_clock::now() - start;
+
+                if(formatted) {
+                    watch.benchmark = std::format(
+                        "lodeb: {:.3f} ms, LLDB: {:.3f} ms ({} elements, warm memory)",
+                        native_time.count(), lldb_time.count(), elem_count
+                    );
+                } else {
+                    watch.benchmark = std::format("No native formatter, LLDB: {:.3f} ms", lldb_time.count());
+                }
+
+                LogInfo("Benchmarked {}: {}", watch.expr, watch.benchmark);
+            } else if(auto* add_wp = std::get_if<AddWatchpointEvent>(&event)) {
+                if(!target_state || !target_state->process_state) {
+                    continue;
+                }
+
+                auto& watchpoints = target_state->watchpoints;
+
+                auto value = add_wp->value;
+
+                if(value.IsValid()) {
+                    watchpoints.Add(value, add_wp->expr, add_wp->read, memory_cache);
+                    continue;
+                }
+
+                std::string_view expr = add_wp->expr;
+
+                int base = 10;
+
+                if(expr.starts_with("0x") || expr.starts_with("0X")) {
+                    expr.remove_prefix(2);
+                    base = 16;
+                }
+
+                lldb::addr_t addr = 0;
+                auto [end, ec] = std::from_chars(expr.data(), expr.data() + expr.size(), addr, base);
+
+                if(ec == std::errc{} && end == expr.data() + expr.size()) {
+                    watchpoints.AddAddress(target_state->target, addr, add_wp->size, add_wp->read, memory_cache);
+                    continue;
+                }
+
+                auto frame = GetCurFrame();
+
+                if(!frame) {
+                    continue;
+                }
+
+                // Typed in by hand, so nothing has evaluated it yet. Same limits as the
+                // watch evaluator so a call into the inferior can't hang the UI.
+                auto opts = WatchEvaluator::Options();
+
+                value = EvaluateWatchExpr(*frame, add_wp->expr.c_str(), ClassifyWatchExpr(add_wp->expr), opts);
+
+                watchpoints.Add(value, add_wp->expr, add_wp->read, memory_cache);
+            } else if(auto* remove_wp = std::get_if<RemoveWatchpointEvent>(&event)) {
+                assert(target_state);
+
+                target_state->watchpoints.Remove(target_state->target, remove_wp->id);
             } else if (auto* select_frame = std::get_if<SetSelectedFrameEvent>(&event)) {
                 assert(target_state);
                 assert(target_state->process_state);
@@ -312,13 +621,48 @@ namespace lodeb {
             }
         }
 
+        process_output_log.Flush();
+
+        locals_tree.Update();
+        PublishWatchedValues();
+
+        // Partial last lines are matched once they're complete
+        process_output_filter.Update(
+            FirstOutputLine(),
+            process_output.DroppedLineCount() + process_output.CompleteLineCount(),
+            [&](size_t line) { return OutputLine(line); }
+        );
+
+        if(target_state && target_state->bp_line_index_dirty) {
+            target_state->bp_line_index.Rebuild(target_state->loc_to_breakpoint);
+            target_state->bp_line_index_dirty = false;
+        }
+
         events = std::move(new_events);
     }
 
+    size_t State::FirstOutputLine() const {
+        return process_output_log.IsOpen() ? 0 : process_output.DroppedLineCount();
+    }
+
+    size_t State::OutputLineCount() const {
+        return process_output.DroppedLineCount() + process_output.LineCount();
+    }
+
+    std::string_view State::OutputLine(size_t line) {
+        size_t dropped = process_output.DroppedLineCount();
+
+        if(line < dropped) {
+            return process_output_log.Line(line);
+        }
+
+        return process_output.Line(line - dropped);
+    }
+
     std::optional<lldb::SBFrame> State::GetCurFrame() {
         if(!target_state ||
            !target_state->process_state ||
-           target_state->process_state->process.GetState() != lldb::eStateStopped) {
+           !target_state->process_state->IsStopped()) {
             return std::nullopt;
         }
 
@@ -352,21 +696,73 @@ namespace lodeb {
             return;
         }
 
-        lldb::SBStream stream;
+        auto& process = target_state->process_state->process;
+
+        // We can get here from the stop event, before the cache has seen the new stop
+        memory_cache.Sync(process);
+        auto stop_key = StopKey::ForFrame(process, *frame);
+
+        watch_state.snapshot.Sync(stop_key);
+
+        std::vector<WatchEvaluator::Request> requests;
 
-        for(auto& [expr, value] : watch_state.expr_values) {
-            if(expr.empty()) {
+        for(size_t i = 0; i < watch_state.expr_values.size(); ++i) {
+            auto& watch = watch_state.expr_values[i];
+
+            if(watch.expr.empty()) {
                 // Don't bother with this
                 continue;
             }
 
-            auto lldb_value = frame->EvaluateExpression(expr.c_str());
+            if(watch.classified_expr != watch.expr) {
+                watch.kind = ClassifyWatchExpr(watch.expr);
+                watch.classified_expr = watch.expr;
+
+                // It's a different value now
+                watch.history.Clear();
+                watch.benchmark.clear();
+                watch.result = {};
+            }
 
-            stream.Clear();
-            lldb_value.GetDescription(stream);
+            watch.pending = true;
 
-            value = stream.GetData();
+            requests.push_back({
+                .index = i,
+                .expr = watch.expr,
+                .kind = watch.kind,
+            });
         }
+
+        watch_state.snapshot_prefix = std::format("{}/{}/", stop_key.thread_id, stop_key.frame_id);
+
+        // Results come in through `PublishWatchedValues`
+        watch_state.evaluator.Start(*frame, process.GetStopID(), std::move(requests), memory_cache, value_formatters);
+    }
+
+    void State::PublishWatchedValues() {
+        watch_state.evaluator.Drain([&](WatchEvaluator::Result& result) {
+            auto& expr_values = watch_state.expr_values;
+
+            // It was edited or removed in the meantime
+            if(result.index >= expr_values.size() || expr_values[result.index].expr != result.expr) {
+                return;
+            }
+
+            auto& watch = expr_values[result.index];
+
+            watch.value = std::move(result.desc);
+            watch.result = result.value;
+            watch.timed_out = result.timed_out;
+            watch.pending = false;
+
+            watch.changed = !result.timed_out &&
+                watch_state.snapshot.Changed(watch_state.snapshot_prefix + watch.expr, result.value, watch.value, memory_cache);
+
+            // Recorded whether or not the watch window is open, it's just a number
+            if(result.number) {
+                watch.history.Record(result.stop_id, *result.number);
+            }
+        });
     }
 }
 
@@ -13,7 +13,24 @@
 #include <lldb/API/LLDB.h>
 
 #include "FileLoc.hpp"
+#include "FrameSnapshot.hpp"
 #include "SymbolLocCache.hpp"
+#include "BreakpointLineIndex.hpp"
+#include "BreakableLineCache.hpp"
+#include "InlineValueCache.hpp"
+#include "MemoryPageCache.hpp"
+#include "OutputBuffer.hpp"
+#include "OutputLog.hpp"
+#include "OutputFilter.hpp"
+#include "OutputMetrics.hpp"
+#include "ProcessOutputReader.hpp"
+#include "ValueFormatters.hpp"
+#include "ValueHistory.hpp"
+#include "ValueSnapshot.hpp"
+#include "VariableTree.hpp"
+#include "WatchEvaluator.hpp"
+#include "WatchpointList.hpp"
+#include "WatchExpr.hpp"
 
 namespace lodeb {
     struct TargetSettings {
@@ -24,15 +41,54 @@ namespace lodeb {
     struct ProcessState {
         lldb::SBListener listener;
         lldb::SBProcess process;
+
+        // Kept up to date from the process events (and set to running as soon as we
+        // resume) so the UI doesn't have to call `GetState` every frame. That takes
+        // the target's API lock, which a watch expression could be holding.
+        lldb::StateType state = lldb::eStateLaunching;
+
+        bool IsStopped() const { return state == lldb::eStateStopped; }
+
+        std::unique_ptr<ProcessOutputReader> output_reader;
     };
 
     struct WatchState {
         struct ExprValue {
             std::string expr;
             std::string value;
+
+            // Since the previous stop
+            bool changed = false;
+
+            // Waiting on the evaluator, `value` is from the last time it was evaluated
+            bool pending = false;
+            bool timed_out = false;
+
+            // What the evaluator produced for `value`, so that the UI can act on it
+            // (watchpoints, benchmarks) without evaluating the expression again
+            lldb::SBValue result;
+
+            // Classification of `expr`, redone whenever `classified_expr` is out of date
+            WatchExprKind kind = WatchExprKind::Expression;
+            std::string classified_expr;
+
+            // Numeric values at every stop, cleared when `expr` changes
+            ValueHistory history;
+            bool show_plot = false;
+
+            // Result of the last `BenchmarkWatchEvent`, if any
+            std::string benchmark;
         };
 
         std::vector<ExprValue> expr_values;
+
+        WatchEvaluator evaluator;
+
+        // Prepended to expressions in `snapshot` so that the same expression in
+        // another frame isn't compared against this one. Set when the evaluator
+        // is started, so it matches whatever results come out of it.
+        std::string snapshot_prefix;
+        ValueSnapshot snapshot;
     };
 
     struct TargetState {
@@ -48,6 +104,20 @@ namespace lodeb {
 
         std::unordered_map<FileLoc, lldb::SBBreakpoint> loc_to_breakpoint;
 
+        // Per-file view of the above for the source view gutter. Marked dirty
+        // whenever breakpoints are added/removed or LLDB tells us they changed
+        // (e.g. they got resolved once the process loaded its modules).
+        BreakpointLineIndex bp_line_index;
+        bool bp_line_index_dirty = false;
+
+        // Lines which have code, for the source view gutter
+        BreakableLineCache breakable_lines;
+
+        // Listens for breakpoint changes and module loads on the target broadcaster
+        lldb::SBListener target_listener;
+
+        WatchpointList watchpoints;
+
         std::optional<ProcessState> process_state;
     };
 
@@ -58,16 +128,74 @@ namespace lodeb {
         int focused_item_index = -1;
     };
 
+    struct SourceSearchState {
+        std::string query;
+
+        // The query that `hits` were computed for. If `query` extends this
+        // we only need to filter the existing hits.
+        std::string hits_query;
+
+        // Sorted offsets into `SourceViewState::text`
+        std::vector<size_t> hits;
+
+        // Index into `hits` that we last jumped to
+        int cur_hit = -1;
+
+        // Scans of very large files happen on a worker
+        std::future<std::vector<size_t>> pending_hits;
+        std::string pending_query;
+
+        bool focus_input = true;
+    };
+
     struct SourceViewState {
         std::string path;
         std::string text;
 
+        // Offset into `text` at which each line starts so we can
+        // jump straight to the lines that are visible.
+        std::vector<size_t> line_starts;
+
+        InlineValueCache inline_values;
+
+        // Only present while the find bar is open
+        std::optional<SourceSearchState> search;
+
+        // So that find can start from what's on screen
+        int first_visible_line = 0;
+
         std::filesystem::file_time_type last_modified_at;
 
         // Only stays valid for one frame
         std::optional<int> scroll_to_line;
     };
 
+    struct ProcessOutputViewState {
+        std::string stdin_text;
+
+        std::string filter_text;
+        bool filter_regex = false;
+
+        // Set if `filter_text` isn't a valid regex
+        bool filter_invalid = false;
+    };
+
+    struct MemoryViewState {
+        std::string addr_expr;
+
+        // What `addr_expr` evaluated to
+        std::optional<lldb::addr_t> addr;
+        std::string error;
+    };
+
+    struct WatchpointViewState {
+        // Address or expression to watch
+        std::string expr;
+
+        // How many bytes to watch, if `expr` is an address
+        int size = 8;
+    };
+
     struct LoadTargetEvent {};
     struct ViewSourceEvent {
         FileLoc loc;
@@ -92,13 +220,49 @@ namespace lodeb {
         uint32_t idx = -1;
     };
 
+    struct WriteStdinEvent {
+        std::string text;
+    };
+
+    struct ViewMemoryEvent {
+        // An address or any expression that evaluates to a pointer/object
+        std::string expr;
+    };
+
+    struct AddWatchpointEvent {
+        // If this isn't valid, `expr` is parsed as an address or evaluated (with the
+        // watch evaluator's limits) instead
+        lldb::SBValue value;
+        std::string expr;
+
+        // Only used for plain addresses
+        size_t size = 8;
+
+        // Otherwise it only triggers on writes
+        bool read = false;
+    };
+
+    struct RemoveWatchpointEvent {
+        lldb::watch_id_t id = 0;
+    };
+
+    // Times our formatter against LLDB's `GetDescription` on a watch
+    struct BenchmarkWatchEvent {
+        size_t index = 0;
+    };
+
     using StateEvent = std::variant<
         LoadTargetEvent, 
         ViewSourceEvent,
         StartProcessEvent,
         ToggleBreakpointEvent,
         ChangeDebugStateEvent,
-        SetSelectedFrameEvent
+        SetSelectedFrameEvent,
+        WriteStdinEvent,
+        ViewMemoryEvent,
+        BenchmarkWatchEvent,
+        AddWatchpointEvent,
+        RemoveWatchpointEvent
     >;
 
     struct State {
@@ -116,7 +280,33 @@ namespace lodeb {
 
         // This is retained at the top level so that we have it
         // even if the previous process/target went away.
-        std::string process_output;
+        OutputBuffer process_output;
+
+        // Everything `process_output` has seen (including what it dropped), on disk.
+        // Only opened when a process is started with `spill_process_output` set.
+        OutputLog process_output_log;
+        bool spill_process_output = true;
+
+        // Launch the process on a pty instead of pipes, so it line buffers its output
+        bool launch_in_pty = false;
+
+        OutputMetrics process_output_metrics;
+
+        OutputFilter process_output_filter;
+        ProcessOutputViewState process_output_view_state;
+
+        VariableTree locals_tree;
+
+        FrameSnapshot frame_snapshot;
+
+        MemoryViewState memory_view_state;
+        WatchpointViewState watchpoint_view_state;
+
+        // Everything that reads process memory goes through this
+        MemoryPageCache memory_cache;
+
+        // Custom string types etc, declared in lodeb.txt
+        ValueFormatters value_formatters;
 
         // We keep this here for reference similar to the `process_output`.
         WatchState watch_state;
@@ -129,8 +319,18 @@ namespace lodeb {
 
         void Update();
 
+        // Kicks off evaluating the watches on a worker
         void ComputeWatchedValues();
 
+        // Picks up whichever watch values have finished evaluating
+        void PublishWatchedValues();
+
+        // Process output lines are numbered from the start of the last launch. Lines
+        // before `FirstOutputLine` were dropped from memory and weren't spilled to disk.
+        size_t FirstOutputLine() const;
+        size_t OutputLineCount() const;
+        std::string_view OutputLine(size_t line);
+
         // SelectedThread->SelectedFrame
         std::optional<lldb::SBFrame> GetCurFrame();
 
@@ -0,0 +1,434 @@
+#include "StdFormatters.hpp"
+
+#include <cstring>
+#include <format>
+#include <string_view>
+#include <vector>
+
+namespace {
+    using namespace lodeb;
+
+    // libstdc++ allocates deque elements in blocks of (at least) this many bytes
+    constexpr uint64_t DEQUE_BLOCK_SIZE = 512;
+
+    // Bounds how far we'll wander around a (possibly corrupt) tree per element shown
+    constexpr size_t MAX_STEPS_PER_NODE = 64;
+
+    std::string_view StripStdNamespace(std::string_view name) {
+        for(std::string_view inline_ns : {"std::__cxx11::", "std::__1::"}) {
+            if(name.starts_with(inline_ns)) {
+                return name.substr(inline_ns.size());
+            }
+        }
+
+        if(name.starts_with("std::")) {
+            return name.substr(5);
+        }
+
+        return {};
+    }
+
+    std::optional<uint64_t> FieldUnsigned(lldb::SBValue& value, const char* path) {
+        auto field = value.GetValueForExpressionPath(path);
+
+        if(!field.IsValid()) {
+            return std::nullopt;
+        }
+
+        lldb::SBError error;
+        auto n = field.GetValueAsUnsigned(error);
+
+        if(error.Fail()) {
+            return std::nullopt;
+        }
+
+        return n;
+    }
+
+    class Reader {
+    public:
+        Reader(MemoryPageCache& memory_cache, uint32_t ptr_size):
+            memory_cache{memory_cache}, ptr_size{ptr_size} {}
+
+        std::optional<lldb::addr_t> Pointer(lldb::addr_t addr) {
+            uint64_t ptr = 0;
+
+            // Little endian, like `ScalarFormat` assumes
+            if(memory_cache.Read(addr, &ptr, ptr_size) != ptr_size) {
+                return std::nullopt;
+            }
+
+            return ptr;
+        }
+
+        bool Bytes(lldb::addr_t addr, uint8_t* out, size_t size) {
+            return memory_cache.Read(addr, out, size) == size;
+        }
+
+        uint32_t PtrSize() const { return ptr_size; }
+
+    private:
+        MemoryPageCache& memory_cache;
+        uint32_t ptr_size;
+    };
+
+    // Scalars are aligned to their size (near enough)
+    uint64_t AlignUp(uint64_t n, uint64_t align) {
+        return align == 0 ? n : (n + align - 1) / align * align;
+    }
+
+    void AppendSeparator(std::string& out, size_t i) {
+        out += i == 0 ? " {" : ", ";
+    }
+
+    void Finish(std::string& out, size_t shown, uint64_t size) {
+        if(shown == 0) {
+            return;
+        }
+
+        if(shown < size) {
+            out += ", ...";
+        }
+
+        out += '}';
+    }
+
+    // Formats `count` elements that are next to each other in memory
+    bool AppendRun(Reader& reader, lldb::addr_t addr, size_t count, const ScalarFormat& format, size_t& shown, std::string& out) {
+        std::vector<uint8_t> bytes(count * format.size);
+
+        if(!reader.Bytes(addr, bytes.data(), bytes.size())) {
+            return false;
+        }
+
+        for(size_t i = 0; i < count; ++i) {
+            AppendSeparator(out, shown++);
+            format.Format(bytes.data() + i * format.size, out);
+        }
+
+        return true;
+    }
+
+    // A `std::pair<const K, V>` of scalars at `addr`
+    bool AppendPair(Reader& reader, lldb::addr_t addr, const StdContainerType& type, size_t& shown, std::string& out) {
+        uint8_t bytes[32];
+
+        auto mapped_offset = AlignUp(type.key_format.size, type.mapped_format.size);
+        auto pair_size = mapped_offset + type.mapped_format.size;
+
+        if(pair_size > sizeof(bytes) || !reader.Bytes(addr, bytes, pair_size)) {
+            return false;
+        }
+
+        AppendSeparator(out, shown++);
+
+        out += '[';
+        type.key_format.Format(bytes, out);
+        out += "] = ";
+        type.mapped_format.Format(bytes + mapped_offset, out);
+
+        return true;
+    }
+
+    std::optional<std::string> FormatVector(lldb::SBValue& raw, const StdContainerType& type, size_t max_elements, Reader& reader) {
+        auto start = FieldUnsigned(raw, "._M_impl._M_start");
+        auto finish = FieldUnsigned(raw, "._M_impl._M_finish");
+
+        if(!start || !finish) {
+            // libc++
+            start = FieldUnsigned(raw, ".__begin_");
+            finish = FieldUnsigned(raw, ".__end_");
+        }
+
+        auto elem_size = type.key_format.size;
+
+        if(!start || !finish || *finish < *start || (*finish - *start) % elem_size != 0) {
+            return std::nullopt;
+        }
+
+        uint64_t size = (*finish - *start) / elem_size;
+
+        std::string out = std::format("size={}", size);
+
+        size_t shown = 0;
+
+        if(!AppendRun(reader, *start, std::min<uint64_t>(size, max_elements), type.key_format, shown, out)) {
+            return std::nullopt;
+        }
+
+        Finish(out, shown, size);
+
+        return out;
+    }
+
+    std::optional<std::string> FormatDeque(lldb::SBValue& raw, const StdContainerType& type, size_t max_elements, Reader& reader) {
+        auto start_cur = FieldUnsigned(raw, "._M_impl._M_start._M_cur");
+        auto start_last = FieldUnsigned(raw, "._M_impl._M_start._M_last");
+        auto start_node = FieldUnsigned(raw, "._M_impl._M_start._M_node");
+        auto finish_cur = FieldUnsigned(raw, "._M_impl._M_finish._M_cur");
+        auto finish_first = FieldUnsigned(raw, "._M_impl._M_finish._M_first");
+        auto finish_node = FieldUnsigned(raw, "._M_impl._M_finish._M_node");
+
+        if(!start_cur || !start_last || !start_node || !finish_cur || !finish_first || !finish_node ||
+           *finish_node < *start_node) {
+            return std::nullopt;
+        }
+
+        int64_t elem_size = type.key_format.size;
+        int64_t block_len = elem_size < static_cast<int64_t>(DEQUE_BLOCK_SIZE) ? DEQUE_BLOCK_SIZE / elem_size : 1;
+
+        // Same as libstdc++'s `operator-` on the iterators
+        int64_t node_count = (*finish_node - *start_node) / reader.PtrSize();
+        int64_t size = block_len * (node_count - 1) +
+                       static_cast<int64_t>(*finish_cur - *finish_first) / elem_size +
+                       static_cast<int64_t>(*start_last - *start_cur) / elem_size;
+
+        if(size < 0) {
+            return std::nullopt;
+        }
+
+        std::string out = std::format("size={}", size);
+
+        size_t shown = 0;
+        size_t want = std::min<uint64_t>(size, max_elements);
+
+        lldb::addr_t cur = *start_cur;
+        lldb::addr_t last = *start_last;
+        lldb::addr_t node = *start_node;
+
+        // One read per block
+        while(shown < want) {
+            if(cur == last) {
+                node += reader.PtrSize();
+
+                auto first = reader.Pointer(node);
+
+                if(!first) {
+                    return std::nullopt;
+                }
+
+                cur = *first;
+                last = cur + block_len * elem_size;
+            }
+
+            size_t count = std::min<uint64_t>((last - cur) / elem_size, want - shown);
+
+            if(!AppendRun(reader, cur, count, type.key_format, shown, out)) {
+                return std::nullopt;
+            }
+
+            cur += count * elem_size;
+        }
+
+        Finish(out, shown, size);
+
+        return out;
+    }
+
+    std::optional<std::string> FormatMap(lldb::SBValue& raw, const StdContainerType& type, size_t max_elements, Reader& reader) {
+        auto header = raw.GetValueForExpressionPath("._M_t._M_impl._M_header");
+        lldb::addr_t header_addr = header.IsValid() ? header.GetLoadAddress() : LLDB_INVALID_ADDRESS;
+
+        auto size = FieldUnsigned(raw, "._M_t._M_impl._M_node_count");
+
+        if(header_addr == LLDB_INVALID_ADDRESS || !size) {
+            return std::nullopt;
+        }
+
+        // `_Rb_tree_node_base` is {color, parent, left, right}, and the color is an
+        // int so it's padded out to a pointer. The value comes right after.
+        uint32_t ptr_size = reader.PtrSize();
+
+        auto parent_of = [&](lldb::addr_t node) { return reader.Pointer(node + ptr_size); };
+        auto left_of = [&](lldb::addr_t node) { return reader.Pointer(node + ptr_size * 2); };
+        auto right_of = [&](lldb::addr_t node) { return reader.Pointer(node + ptr_size * 3); };
+
+        lldb::addr_t value_offset = ptr_size * 4;
+
+        std::string out = std::format("size={}", *size);
+
+        size_t shown = 0;
+        size_t want = std::min<uint64_t>(*size, max_elements);
+        size_t steps_left = want * MAX_STEPS_PER_NODE;
+
+        // The header's left is the leftmost (smallest) node
+        auto node = left_of(header_addr);
+
+        while(shown < want) {
+            if(!node || *node == header_addr || !AppendPair(reader, *node + value_offset, type, shown, out)) {
+                return std::nullopt;
+            }
+
+            // Don't walk past the last one we show
+            if(shown == want) {
+                break;
+            }
+
+            // In-order successor, like `_Rb_tree_increment`. Running out of steps
+            // partway through means the tree is corrupt (or cyclic).
+            auto x = *node;
+
+            if(auto right = right_of(x); right && *right != 0) {
+                x = *right;
+
+                for(auto left = left_of(x); left && *left != 0; left = left_of(x)) {
+                    if(steps_left == 0) {
+                        return std::nullopt;
+                    }
+
+                    --steps_left;
+                    x = *left;
+                }
+            } else {
+                auto y = parent_of(x);
+
+                for(auto y_right = y ? right_of(*y) : std::nullopt; y_right && *y_right == x; y_right = y ? right_of(*y) : std::nullopt) {
+                    if(steps_left == 0) {
+                        return std::nullopt;
+                    }
+
+                    --steps_left;
+                    x = *y;
+                    y = parent_of(x);
+                }
+
+                if(!y) {
+                    return std::nullopt;
+                }
+
+                if(auto x_right = right_of(x); x_right && *x_right != *y) {
+                    x = *y;
+                }
+            }
+
+            node = x;
+        }
+
+        Finish(out, shown, *size);
+
+        return out;
+    }
+
+    std::optional<std::string> FormatUnorderedMap(lldb::SBValue& raw, const StdContainerType& type, size_t max_elements, Reader& reader) {
+        auto first = FieldUnsigned(raw, "._M_h._M_before_begin._M_nxt");
+        auto size = FieldUnsigned(raw, "._M_h._M_element_count");
+
+        if(!first || !size) {
+            return std::nullopt;
+        }
+
+        // Nodes are {next, value[, cached hash]}
+        auto value_offset = AlignUp(reader.PtrSize(), std::max(type.key_format.size, type.mapped_format.size));
+
+        std::string out = std::format("size={}", *size);
+
+        size_t shown = 0;
+        size_t want = std::min<uint64_t>(*size, max_elements);
+
+        std::optional<lldb::addr_t> node = *first;
+
+        while(shown < want) {
+            if(!node || *node == 0 || !AppendPair(reader, *node + value_offset, type, shown, out)) {
+                return std::nullopt;
+            }
+
+            node = reader.Pointer(*node);
+        }
+
+        Finish(out, shown, *size);
+
+        return out;
+    }
+}
+
+namespace lodeb {
+    StdContainerType StdContainerType::ForType(lldb::SBType type) {
+        StdContainerType result;
+
+        if(!type.IsValid()) {
+            return result;
+        }
+
+        auto canonical = type.GetCanonicalType().GetUnqualifiedType();
+        auto* name = canonical.GetName();
+
+        if(!name) {
+            return result;
+        }
+
+        auto unqualified = StripStdNamespace(name);
+
+        Kind kind = None;
+        uint32_t arg_count = 1;
+
+        // vector<bool> is packed, so it's not an array of bools
+        if(unqualified.starts_with("vector<") && !unqualified.starts_with("vector<bool,")) {
+            kind = Vector;
+        } else if(unqualified.starts_with("deque<")) {
+            kind = Deque;
+        } else if(unqualified.starts_with("map<")) {
+            kind = Map;
+            arg_count = 2;
+        } else if(unqualified.starts_with("unordered_map<")) {
+            kind = UnorderedMap;
+            arg_count = 2;
+        } else {
+            return result;
+        }
+
+        if(canonical.GetNumberOfTemplateArguments() < arg_count) {
+            return result;
+        }
+
+        auto key_format = ScalarFormat::ForType(canonical.GetTemplateArgumentType(0));
+
+        if(!key_format || key_format->size == 0) {
+            return result;
+        }
+
+        result.key_format = *key_format;
+
+        if(arg_count == 2) {
+            auto mapped_format = ScalarFormat::ForType(canonical.GetTemplateArgumentType(1));
+
+            if(!mapped_format || mapped_format->size == 0) {
+                return result;
+            }
+
+            result.mapped_format = *mapped_format;
+        }
+
+        result.kind = kind;
+
+        return result;
+    }
+
+    std::optional<std::string> FormatStdContainer(
+        lldb::SBValue& value,
+        const StdContainerType& type,
+        size_t max_elements,
+        MemoryPageCache& memory_cache
+    ) {
+        // We want the actual members, not what the synthetic provider makes up
+        auto raw = value.GetNonSyntheticValue();
+
+        if(!raw.IsValid()) {
+            return std::nullopt;
+        }
+
+        Reader reader{memory_cache, value.GetProcess().GetAddressByteSize()};
+
+        if(reader.PtrSize() != 4 && reader.PtrSize() != 8) {
+            return std::nullopt;
+        }
+
+        switch(type.kind) {
+            case StdContainerType::Vector: return FormatVector(raw, type, max_elements, reader);
+            case StdContainerType::Deque: return FormatDeque(raw, type, max_elements, reader);
+            case StdContainerType::Map: return FormatMap(raw, type, max_elements, reader);
+            case StdContainerType::UnorderedMap: return FormatUnorderedMap(raw, type, max_elements, reader);
+
+            default: return std::nullopt;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "ScalarFormat.hpp"
+
+namespace lodeb {
+    // Standard containers we know how to walk ourselves, since LLDB's synthetic
+    // providers create an `SBValue` per element (and per tree/list node) which
+    // is slow for big containers.
+    //
+    // We only know the libstdc++ layouts (plus `std::vector` on libc++, which is
+    // just two pointers). Anything else, and containers of anything other than
+    // scalars, is left to LLDB.
+    struct StdContainerType {
+        enum Kind {
+            None,
+            Vector,
+            Deque,
+            Map,
+            UnorderedMap,
+        };
+
+        Kind kind = None;
+
+        // The element type, or the key type for maps
+        ScalarFormat key_format;
+
+        // Only used by maps
+        ScalarFormat mapped_format;
+
+        // `kind` is `None` if we can't do anything with the type
+        static StdContainerType ForType(lldb::SBType type);
+    };
+
+    // Gives something like "size=3 {1, 2, 3}", showing at most `max_elements`. Nodes
+    // and element data are read through `memory_cache`. Empty if the container
+    // isn't laid out the way we expect.
+    std::optional<std::string> FormatStdContainer(
+        lldb::SBValue& value,
+        const StdContainerType& type,
+        size_t max_elements,
+        MemoryPageCache& memory_cache
+    );
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+#include <lldb/API/LLDB.h>
+
+namespace lodeb {
+    // Identifies what a cache of per-stop data was computed for, so it can tell
+    // when it has to start over. Stop IDs restart with every process, hence the
+    // process ID.
+    struct StopKey {
+        uint32_t process_id = 0;
+        uint32_t stop_id = 0;
+        lldb::tid_t thread_id = 0;
+
+        // Left at 0 by caches that cover the whole thread
+        uint32_t frame_id = 0;
+
+        bool operator==(const StopKey&) const = default;
+
+        static StopKey ForThread(lldb::SBProcess& process, lldb::SBThread& thread) {
+            return {
+                .process_id = process.GetUniqueID(),
+                .stop_id = process.GetStopID(),
+                .thread_id = thread.GetThreadID(),
+            };
+        }
+
+        static StopKey ForFrame(lldb::SBProcess& process, lldb::SBFrame& frame) {
+            auto thread = frame.GetThread();
+            auto key = ForThread(process, thread);
+
+            key.frame_id = frame.GetFrameID();
+
+            return key;
+        }
+    };
+}
@@ -0,0 +1,152 @@
+#include "TextSearch.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+    char ToLower(char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+    }
+
+    bool IsAlpha(char c) {
+        c = ToLower(c);
+        return c >= 'a' && c <= 'z';
+    }
+
+    // `lower_needle` must already be lowercase
+    bool MatchesAt(std::string_view haystack, size_t pos, std::string_view lower_needle) {
+        if(pos + lower_needle.size() > haystack.size()) {
+            return false;
+        }
+
+        for(size_t i = 0; i < lower_needle.size(); ++i) {
+            if(ToLower(haystack[pos + i]) != lower_needle[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // For ASCII letters, `(c | 0x20) == lower` is true exactly for the upper and
+    // lower case version of the letter, so we can do case-insensitive compares
+    // with one OR. For anything else the OR mask is 0 and it's an exact compare.
+    struct FoldedChar {
+        uint8_t or_mask = 0;
+        uint8_t lower = 0;
+
+        explicit FoldedChar(char c):
+            or_mask{static_cast<uint8_t>(IsAlpha(c) ? 0x20 : 0)},
+            lower{static_cast<uint8_t>(ToLower(c))} {}
+    };
+}
+
+namespace lodeb {
+    void FindAllCaseInsensitive(std::string_view haystack, std::string_view needle, std::vector<size_t>& hits) {
+        if(needle.empty() || needle.size() > haystack.size()) {
+            return;
+        }
+
+        std::string lower_needle{needle};
+
+        for(auto& c : lower_needle) {
+            c = ToLower(c);
+        }
+
+        const size_t m = needle.size();
+        const size_t last_start = haystack.size() - m;
+
+        FoldedChar first{needle.front()};
+        FoldedChar last{needle.back()};
+
+        const auto* data = reinterpret_cast<const uint8_t*>(haystack.data());
+
+        size_t i = 0;
+
+#if defined(__SSE2__)
+        const __m128i first_or = _mm_set1_epi8(static_cast<char>(first.or_mask));
+        const __m128i first_lower = _mm_set1_epi8(static_cast<char>(first.lower));
+        const __m128i last_or = _mm_set1_epi8(static_cast<char>(last.or_mask));
+        const __m128i last_lower = _mm_set1_epi8(static_cast<char>(last.lower));
+
+        // The last-char load reads [i + m - 1, i + m + 15)
+        for(; i + m + 15 <= haystack.size(); i += 16) {
+            __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + m - 1));
+
+            __m128i eq_first = _mm_cmpeq_epi8(_mm_or_si128(block_first, first_or), first_lower);
+            __m128i eq_last = _mm_cmpeq_epi8(_mm_or_si128(block_last, last_or), last_lower);
+
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last)));
+
+            while(mask) {
+                auto bit = static_cast<size_t>(__builtin_ctz(mask));
+
+                if(MatchesAt(haystack, i + bit, lower_needle)) {
+                    hits.push_back(i + bit);
+                }
+
+                mask &= mask - 1;
+            }
+        }
+#elif defined(__ARM_NEON)
+        const uint8x16_t first_or = vdupq_n_u8(first.or_mask);
+        const uint8x16_t first_lower = vdupq_n_u8(first.lower);
+        const uint8x16_t last_or = vdupq_n_u8(last.or_mask);
+        const uint8x16_t last_lower = vdupq_n_u8(last.lower);
+
+        for(; i + m + 15 <= haystack.size(); i += 16) {
+            uint8x16_t block_first = vld1q_u8(data + i);
+            uint8x16_t block_last = vld1q_u8(data + i + m - 1);
+
+            uint8x16_t eq = vandq_u8(
+                vceqq_u8(vorrq_u8(block_first, first_or), first_lower),
+                vceqq_u8(vorrq_u8(block_last, last_or), last_lower)
+            );
+
+            // NEON has no movemask, so narrow each byte to a nibble instead
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+
+            while(mask) {
+                auto bit = static_cast<size_t>(__builtin_ctzll(mask)) / 4;
+
+                if(MatchesAt(haystack, i + bit, lower_needle)) {
+                    hits.push_back(i + bit);
+                }
+
+                mask &= ~(uint64_t{0xF} << (bit * 4));
+            }
+        }
+#endif
+
+        // Tail (or everything, if we don't have SIMD)
+        for(; i <= last_start; ++i) {
+            if((data[i] | first.or_mask) != first.lower) {
+                continue;
+            }
+
+            if(MatchesAt(haystack, i, lower_needle)) {
+                hits.push_back(i);
+            }
+        }
+    }
+
+    void RefineHits(std::string_view haystack, std::string_view needle, std::vector<size_t>& hits) {
+        std::string lower_needle{needle};
+
+        for(auto& c : lower_needle) {
+            c = ToLower(c);
+        }
+
+        std::erase_if(hits, [&](size_t pos) {
+            return !MatchesAt(haystack, pos, lower_needle);
+        });
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+namespace lodeb {
+    // Appends the offset of every (possibly overlapping) ASCII case-insensitive
+    // occurrence of `needle` in `haystack` to `hits`, in ascending order.
+    //
+    // Uses SIMD to find candidate positions by the first and last char of the
+    // needle 16 bytes at a time, so it's fast enough for multi-megabyte files.
+    void FindAllCaseInsensitive(std::string_view haystack, std::string_view needle, std::vector<size_t>& hits);
+
+    // Removes hits that don't match `needle`. If the previous needle was a prefix of
+    // this one, that's all we need to do instead of scanning the haystack again.
+    void RefineHits(std::string_view haystack, std::string_view needle, std::vector<size_t>& hits);
+}
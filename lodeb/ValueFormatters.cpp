@@ -0,0 +1,257 @@
+#include "ValueFormatters.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+
+#include "Log.hpp"
+
+namespace {
+    using namespace lodeb;
+
+    void AppendUtf8(uint32_t cp, std::string& out) {
+        if(cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if(cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if(cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Like LLDB, so these look the same as regular strings
+    void AppendEscaped(uint32_t cp, std::string& out) {
+        switch(cp) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+
+            default:
+                if(cp < 0x20 || cp == 0x7F) {
+                    std::format_to(std::back_inserter(out), "\\x{:02x}", cp);
+                } else {
+                    AppendUtf8(cp, out);
+                }
+                break;
+        }
+    }
+
+    size_t UnitSize(StringLayout::Encoding encoding) {
+        switch(encoding) {
+            case StringLayout::Utf16: return 2;
+            case StringLayout::Utf32: return 4;
+            default: return 1;
+        }
+    }
+
+    uint32_t LoadUnit(const uint8_t* data, size_t unit_size) {
+        uint32_t unit = 0;
+
+        if(unit_size == 1) {
+            unit = data[0];
+        } else if(unit_size == 2) {
+            uint16_t u16;
+            std::memcpy(&u16, data, 2);
+
+            unit = u16;
+        } else {
+            std::memcpy(&unit, data, 4);
+        }
+
+        return unit;
+    }
+
+    // libstdc++'s. The fields won't be there on libc++ so we'll leave it to LLDB.
+    const StringLayout STD_STRING_LAYOUT = {
+        .type_pattern = "std::string",
+        .ptr_field = "_M_dataplus._M_p",
+        .len_field = "_M_string_length",
+    };
+
+    bool IsStdString(std::string_view name) {
+        return name.starts_with("std::__cxx11::basic_string<char,") ||
+               name.starts_with("std::basic_string<char,");
+    }
+
+    lldb::SBValue GetField(lldb::SBValue& value, const std::string& field) {
+        std::string path = "." + field;
+        return value.GetValueForExpressionPath(path.c_str());
+    }
+}
+
+namespace lodeb {
+    bool ValueFormatters::AddStringLayout(StringLayout layout) {
+        std::regex regex;
+
+        try {
+            regex = std::regex{layout.type_pattern};
+        } catch(const std::regex_error& e) {
+            LogError("Invalid string_formatter pattern {}: {}", layout.type_pattern, e.what());
+            return false;
+        }
+
+        std::lock_guard lock{mutex};
+
+        string_layouts.push_back(std::move(layout));
+        string_layout_regexes.push_back(std::move(regex));
+
+        // Might match types we've already looked at
+        type_to_formatter.clear();
+
+        return true;
+    }
+
+    std::optional<std::string> ValueFormatters::Format(lldb::SBValue& value, MemoryPageCache& memory_cache) {
+        auto formatter = FindFormatter(value.GetType());
+
+        if(formatter.string_layout) {
+            return FormatString(value, *formatter.string_layout, memory_cache);
+        }
+
+        if(formatter.container.kind != StdContainerType::None) {
+            return FormatStdContainer(value, formatter.container, MAX_ELEMENTS, memory_cache);
+        }
+
+        return std::nullopt;
+    }
+
+    ValueFormatters::TypeFormatter ValueFormatters::FindFormatter(lldb::SBType type) {
+        if(!type.IsValid()) {
+            return {};
+        }
+
+        auto* name = type.GetUnqualifiedType().GetName();
+
+        if(!name) {
+            return {};
+        }
+
+        std::lock_guard lock{mutex};
+
+        auto found = type_to_formatter.find(name);
+
+        if(found != type_to_formatter.end()) {
+            return found->second;
+        }
+
+        TypeFormatter formatter;
+
+        auto* canonical_name = type.GetCanonicalType().GetUnqualifiedType().GetName();
+
+        // User declared layouts come first. Typedefs are checked under both names.
+        for(size_t i = 0; i < string_layout_regexes.size() && !formatter.string_layout; ++i) {
+            if(std::regex_match(name, string_layout_regexes[i]) ||
+               (canonical_name && std::regex_match(canonical_name, string_layout_regexes[i]))) {
+                formatter.string_layout = &string_layouts[i];
+            }
+        }
+
+        if(!formatter.string_layout && canonical_name && IsStdString(canonical_name)) {
+            formatter.string_layout = &STD_STRING_LAYOUT;
+        }
+
+        if(!formatter.string_layout) {
+            formatter.container = StdContainerType::ForType(type);
+        }
+
+        type_to_formatter.emplace(name, formatter);
+
+        return formatter;
+    }
+
+    std::optional<std::string> ValueFormatters::FormatString(lldb::SBValue& value, const StringLayout& layout, MemoryPageCache& memory_cache) {
+        auto ptr = GetField(value, layout.ptr_field);
+
+        if(!ptr.IsValid()) {
+            return std::nullopt;
+        }
+
+        lldb::addr_t addr = ptr.GetType().IsArrayType() ? ptr.GetLoadAddress() : ptr.GetValueAsUnsigned(LLDB_INVALID_ADDRESS);
+
+        if(addr == LLDB_INVALID_ADDRESS) {
+            return std::nullopt;
+        }
+
+        if(addr == 0) {
+            return "nullptr";
+        }
+
+        size_t unit_size = UnitSize(layout.encoding);
+        size_t len = MAX_STRING_LEN;
+        uint64_t full_len = 0;
+
+        bool null_terminated = layout.len_field.empty();
+
+        if(!null_terminated) {
+            auto len_value = GetField(value, layout.len_field);
+
+            if(!len_value.IsValid()) {
+                return std::nullopt;
+            }
+
+            full_len = len_value.GetValueAsUnsigned();
+            len = std::min<uint64_t>(full_len, MAX_STRING_LEN);
+        }
+
+        // The whole thing in one read (the cache merges the pages it needs)
+        std::vector<uint8_t> bytes(len * unit_size);
+        size_t read = memory_cache.Read(addr, bytes.data(), bytes.size());
+
+        if(!null_terminated && read < bytes.size()) {
+            return std::nullopt;
+        }
+
+        size_t units = read / unit_size;
+
+        std::string out = "\"";
+
+        bool terminated = false;
+
+        for(size_t i = 0; i < units; ++i) {
+            uint32_t unit = LoadUnit(bytes.data() + i * unit_size, unit_size);
+
+            if(null_terminated && unit == 0) {
+                terminated = true;
+                break;
+            }
+
+            uint32_t cp = unit;
+
+            if(layout.encoding == StringLayout::Utf16 && unit >= 0xD800 && unit < 0xDC00 && i + 1 < units) {
+                uint32_t low = LoadUnit(bytes.data() + (i + 1) * unit_size, unit_size);
+
+                if(low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                    i += 1;
+                }
+            }
+
+            // UTF-8 is passed through byte by byte, everything else is re-encoded
+            if(layout.encoding == StringLayout::Utf8 && cp >= 0x80) {
+                out += static_cast<char>(cp);
+            } else {
+                AppendEscaped(cp, out);
+            }
+        }
+
+        out += '"';
+
+        bool truncated = null_terminated ? !terminated : len < full_len;
+
+        if(truncated) {
+            out += "...";
+        }
+
+        return out;
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "StdFormatters.hpp"
+
+namespace lodeb {
+    // Where to find the characters of a custom string type, declared in lodeb.txt
+    // like so:
+    //
+    //     string_formatter "mylib::Str" ptr len utf8
+    //     string_formatter "SmallString<.*>" buf.data - utf8
+    //
+    // The type pattern is a regex matched against the whole type name. Fields can
+    // be nested with '.', and a length of '-' means the string is null terminated.
+    // If the pointer field is an array (i.e. an inline buffer), its address is used.
+    struct StringLayout {
+        enum Encoding {
+            Utf8,
+            Utf16,
+            Utf32,
+        };
+
+        std::string type_pattern;
+        std::string ptr_field;
+
+        // Empty if null terminated
+        std::string len_field;
+
+        Encoding encoding = Utf8;
+    };
+
+    // Formats values of types we know the layout of ourselves, reading their
+    // contents in bulk through the memory cache instead of going through LLDB's
+    // formatters (or lack thereof). That's the string types from lodeb.txt,
+    // `std::string` and the containers in `StdContainerType`.
+    //
+    // Which formatter (if any) applies to a type is worked out once per type.
+    // Safe to use from workers.
+    class ValueFormatters {
+    public:
+        // Strings longer than this (in code units) are cut off
+        static constexpr size_t MAX_STRING_LEN = 4096;
+
+        // Containers show at most this many elements
+        static constexpr size_t MAX_ELEMENTS = 64;
+
+        // Returns false if the pattern isn't a valid regex
+        bool AddStringLayout(StringLayout layout);
+
+        const std::deque<StringLayout>& StringLayouts() const { return string_layouts; }
+
+        // Empty if we don't have a formatter for the value's type, or it couldn't be read
+        std::optional<std::string> Format(lldb::SBValue& value, MemoryPageCache& memory_cache);
+
+    private:
+        // A deque so that `TypeFormatter`s pointing into it stay valid as it grows
+        std::deque<StringLayout> string_layouts;
+        std::vector<std::regex> string_layout_regexes;
+
+        std::mutex mutex;
+
+        struct TypeFormatter {
+            // Either one of `string_layouts` or `STD_STRING_LAYOUT`
+            const StringLayout* string_layout = nullptr;
+
+            StdContainerType container;
+        };
+
+        // SBType isn't hashable, so we go by its name
+        std::unordered_map<std::string, TypeFormatter> type_to_formatter;
+
+        TypeFormatter FindFormatter(lldb::SBType type);
+
+        std::optional<std::string> FormatString(lldb::SBValue& value, const StringLayout& layout, MemoryPageCache& memory_cache);
+    };
+}
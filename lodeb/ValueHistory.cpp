@@ -0,0 +1,50 @@
+#include "ValueHistory.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#include "Log.hpp"
+
+namespace lodeb {
+    void ValueHistory::Record(uint32_t stop_id, double value) {
+        if(!samples.empty()) {
+            size_t last = (head + samples.size() - 1) % samples.size();
+
+            if(samples[last].stop_id == stop_id) {
+                samples[last].value = value;
+                return;
+            }
+        }
+
+        if(samples.size() < CAPACITY) {
+            samples.push_back({stop_id, value});
+            return;
+        }
+
+        samples[head] = {stop_id, value};
+        head = (head + 1) % CAPACITY;
+    }
+
+    void ValueHistory::Clear() {
+        samples.clear();
+        head = 0;
+    }
+
+    bool ValueHistory::Export(const char* path) const {
+        std::ofstream file{path};
+
+        if(!file) {
+            LogError("Failed to open {} for export: {}", path, strerror(errno));
+            return false;
+        }
+
+        file << "stop_id,value\n";
+
+        for(size_t i = 0; i < Size(); ++i) {
+            auto& sample = (*this)[i];
+            file << sample.stop_id << ',' << sample.value << '\n';
+        }
+
+        return true;
+    }
+}
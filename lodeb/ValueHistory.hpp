@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lodeb {
+    // The value of a numeric watch at each stop, kept in a fixed size ring
+    // buffer so it can be plotted.
+    class ValueHistory {
+    public:
+        static constexpr size_t CAPACITY = 1024;
+
+        struct Sample {
+            uint32_t stop_id = 0;
+            double value = 0;
+        };
+
+        // Replaces the last sample if it's for the same stop (e.g. we re-evaluated
+        // because the selected frame changed), otherwise drops the oldest sample
+        // once we're at capacity.
+        void Record(uint32_t stop_id, double value);
+
+        void Clear();
+
+        size_t Size() const { return samples.size(); }
+
+        // Oldest first
+        const Sample& operator[](size_t idx) const {
+            return samples[(head + idx) % samples.size()];
+        }
+
+        // As CSV with a header
+        bool Export(const char* path) const;
+
+    private:
+        std::vector<Sample> samples;
+
+        // Index of the oldest sample once `samples` is full
+        size_t head = 0;
+    };
+}
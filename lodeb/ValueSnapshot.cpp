@@ -0,0 +1,81 @@
+#include "ValueSnapshot.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    // Bytes past this aren't hashed, so a change deep inside a huge object can be missed
+    constexpr size_t MAX_HASHED_BYTES = 4096;
+
+    // FNV-1a
+    uint64_t Hash(uint64_t hash, const void* data, size_t size) {
+        auto* bytes = static_cast<const uint8_t*>(data);
+
+        for(size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+}
+
+namespace lodeb {
+    void ValueSnapshot::Sync(const StopKey& key) {
+        StopKey new_key = {
+            .process_id = key.process_id,
+            .stop_id = key.stop_id,
+        };
+
+        if(this->key == new_key) {
+            return;
+        }
+
+        this->key = new_key;
+
+        prev = std::move(cur);
+        cur.clear();
+    }
+
+    bool ValueSnapshot::Changed(const std::string& key, lldb::SBValue& value, std::string_view value_str, MemoryPageCache& memory_cache) {
+        Entry entry;
+
+        uint8_t buf[MAX_HASHED_BYTES];
+        size_t size = 0;
+
+        auto addr = value.GetLoadAddress();
+
+        if(addr != LLDB_INVALID_ADDRESS) {
+            entry.size = static_cast<uint32_t>(value.GetByteSize());
+            size = memory_cache.Read(addr, buf, std::min<size_t>(entry.size, sizeof(buf)));
+        } else {
+            // In a register or computed by a synthetic provider
+            auto data = value.GetData();
+
+            lldb::SBError err;
+
+            if(data.IsValid()) {
+                entry.size = static_cast<uint32_t>(data.GetByteSize());
+                size = data.ReadRawData(err, 0, buf, std::min<size_t>(entry.size, sizeof(buf)));
+            }
+
+            if(err.Fail()) {
+                size = 0;
+            }
+        }
+        entry.hash = Hash(Hash(0xcbf29ce484222325ull, buf, size), value_str.data(), value_str.size());
+
+        std::memcpy(entry.prefix, buf, std::min(size, PREFIX_SIZE));
+
+        cur[key] = entry;
+
+        // LLDB knows for sure when it's the same value object as last stop
+        if(value.GetValueDidChange()) {
+            return true;
+        }
+
+        auto found = prev.find(key);
+
+        return found != prev.end() && !(found->second == entry);
+    }
+}
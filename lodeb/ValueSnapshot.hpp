@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "StopKey.hpp"
+
+namespace lodeb {
+    // A compact record of the values we displayed at the current and previous
+    // stop, so we can highlight the ones that changed in between.
+    //
+    // Only a hash and a small prefix of each value's bytes are kept, and only
+    // values that were actually asked about are recorded, so this stays cheap
+    // no matter how many variables there are.
+    class ValueSnapshot {
+    public:
+        // When `key` is at a different stop (or process) than last time, what has been
+        // recorded so far becomes the previous stop's snapshot. Its thread and frame
+        // are ignored, callers put those in the keys they pass to `Changed`.
+        void Sync(const StopKey& key);
+
+        // Records `value` under `key` and returns whether it's different from what
+        // was recorded at the previous stop. Values we didn't see at the previous
+        // stop are not considered changed.
+        //
+        // `value_str` is hashed in as well, since the bytes of e.g. a `std::vector`
+        // don't change when one of its elements does.
+        //
+        // Values that live in memory are read through `memory_cache`.
+        bool Changed(const std::string& key, lldb::SBValue& value, std::string_view value_str, MemoryPageCache& memory_cache);
+
+    private:
+        static constexpr size_t PREFIX_SIZE = 16;
+
+        struct Entry {
+            uint64_t hash = 0;
+            uint32_t size = 0;
+            uint8_t prefix[PREFIX_SIZE] = {};
+
+            bool operator==(const Entry&) const = default;
+        };
+
+        std::optional<StopKey> key;
+
+        std::unordered_map<std::string, Entry> prev;
+        std::unordered_map<std::string, Entry> cur;
+    };
+}
@@ -0,0 +1,308 @@
+#include "VariableTree.hpp"
+
+#include <algorithm>
+#include <format>
+
+#include "Log.hpp"
+#include "ScalarFormat.hpp"
+
+namespace lodeb {
+    void VariableTree::Sync(lldb::SBProcess& process, lldb::SBFrame& frame, MemoryPageCache& memory_cache, ValueFormatters& formatters) {
+        auto new_key = StopKey::ForFrame(process, frame);
+
+        if(key == new_key) {
+            return;
+        }
+
+        Cancel();
+
+        key = new_key;
+
+        this->memory_cache = &memory_cache;
+        this->formatters = &formatters;
+
+        pending_cancelled = std::make_shared<std::atomic<bool>>(false);
+
+        // HACK(Apaar): Reads from the process on another thread, we rely on LLDB's API lock
+        pending = std::async(std::launch::async, Fetch, frame, new_key, expanded_paths, &memory_cache, &formatters, pending_cancelled);
+    }
+
+    void VariableTree::Update() {
+        std::erase_if(cancelled, [](std::future<FetchResult>& fetch) {
+            return fetch.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+        });
+
+        if(!pending || pending->wait_for(std::chrono::seconds::zero()) != std::future_status::ready) {
+            return;
+        }
+
+        auto result = pending->get();
+
+        pending.reset();
+        pending_cancelled.reset();
+
+        roots = std::move(result.roots);
+
+        snapshot.Sync(result.key);
+        snapshot_prefix = std::move(result.func_name);
+    }
+
+    void VariableTree::Cancel() {
+        if(!pending) {
+            return;
+        }
+
+        *pending_cancelled = true;
+
+        cancelled.push_back(std::move(*pending));
+
+        pending.reset();
+        pending_cancelled.reset();
+
+        // So that we fetch again even if we end up back at the same stop
+        key.reset();
+    }
+
+    std::vector<VariableTree::Node>& VariableTree::Children(Node& node) {
+        if(!node.children_fetched) {
+            FetchChildren(node, *memory_cache, *formatters);
+        }
+
+        return node.children;
+    }
+
+    bool VariableTree::Changed(Node& node) {
+        if(!node.changed) {
+            node.changed = snapshot.Changed(snapshot_prefix + '/' + node.path, node.value, node.value_str, *memory_cache);
+        }
+
+        return *node.changed;
+    }
+
+    void VariableTree::SetExpanded(const Node& node, bool expanded) {
+        if(expanded) {
+            expanded_paths.emplace(node.path, node.page_start);
+        } else {
+            expanded_paths.erase(node.path);
+        }
+    }
+
+    void VariableTree::SetPage(Node& node, uint32_t index) {
+        uint32_t page_start = index - index % PAGE_SIZE;
+
+        if(page_start == node.page_start) {
+            return;
+        }
+
+        node.page_start = page_start;
+        node.children_fetched = false;
+        node.children.clear();
+
+        expanded_paths[node.path] = page_start;
+    }
+
+    VariableTree::FetchResult VariableTree::Fetch(
+        lldb::SBFrame frame,
+        StopKey key,
+        ExpandedPaths expanded_paths,
+        MemoryPageCache* memory_cache,
+        ValueFormatters* formatters,
+        std::shared_ptr<std::atomic<bool>> cancelled
+    ) {
+        LogDebug("Getting variables again");
+
+        FetchResult result = {
+            .key = key,
+        };
+
+        auto* func_name = frame.GetFunctionName();
+        result.func_name = func_name ? func_name : "";
+
+        lldb::SBVariablesOptions opts;
+
+        opts.SetIncludeLocals(true);
+        opts.SetIncludeArguments(true);
+        opts.SetInScopeOnly(true);
+
+        auto values = frame.GetVariables(opts);
+
+        for(auto i = 0u; i < values.GetSize() && !*cancelled; ++i) {
+            auto value = values.GetValueAtIndex(i);
+
+            if(!value.GetName()) {
+                continue;
+            }
+
+            result.roots.push_back(MakeNode(value, {}, *memory_cache, *formatters));
+        }
+
+        // Re-resolve whatever was expanded at the last stop by name
+        for(auto& root : result.roots) {
+            FetchExpanded(root, expanded_paths, *memory_cache, *formatters, *cancelled);
+        }
+
+        if(*cancelled) {
+            LogDebug("Cancelled getting variables for stop {}", key.stop_id);
+        }
+
+        return result;
+    }
+
+    void VariableTree::FetchExpanded(
+        Node& node,
+        const ExpandedPaths& expanded_paths,
+        MemoryPageCache& memory_cache,
+        ValueFormatters& formatters,
+        const std::atomic<bool>& cancelled
+    ) {
+        if(cancelled || !node.might_have_children) {
+            return;
+        }
+
+        auto found = expanded_paths.find(node.path);
+
+        if(found == expanded_paths.end()) {
+            return;
+        }
+
+        node.page_start = found->second;
+
+        FetchChildren(node, memory_cache, formatters);
+
+        for(auto& child : node.children) {
+            FetchExpanded(child, expanded_paths, memory_cache, formatters, cancelled);
+        }
+    }
+
+    void VariableTree::FetchChildren(Node& node, MemoryPageCache& memory_cache, ValueFormatters& formatters) {
+        node.children_fetched = true;
+        node.children.clear();
+
+        node.num_children = node.value.GetNumChildren();
+
+        if(node.page_start >= node.num_children) {
+            node.page_start = 0;
+        }
+
+        uint32_t end = std::min(node.num_children, node.page_start + PAGE_SIZE);
+
+        if(ReadScalarChildren(node, end, memory_cache)) {
+            return;
+        }
+
+        node.children.reserve(end - node.page_start);
+
+        for(auto i = node.page_start; i < end; ++i) {
+            node.children.push_back(MakeNode(node.value.GetChildAtIndex(i), node.path, memory_cache, formatters));
+        }
+    }
+
+    bool VariableTree::ReadScalarChildren(Node& node, uint32_t end, MemoryPageCache& memory_cache) {
+        // Not worth it for a handful of elements
+        if(end - node.page_start < 16) {
+            return false;
+        }
+
+        auto type = node.value.GetType().GetCanonicalType();
+
+        lldb::SBType elem_type;
+        lldb::addr_t base_addr = LLDB_INVALID_ADDRESS;
+
+        if(type.IsArrayType()) {
+            elem_type = type.GetArrayElementType();
+            base_addr = node.value.GetLoadAddress();
+        } else if(node.value.IsSynthetic() && node.type_name.find("vector<") != std::string::npos) {
+            // The synthetic children of a vector point straight into its buffer, so we
+            // can tell it's contiguous from the first two (this rules out vector<bool>).
+            auto first = node.value.GetChildAtIndex(0);
+            auto second = node.value.GetChildAtIndex(1);
+
+            elem_type = first.GetType();
+            base_addr = first.GetLoadAddress();
+
+            if(base_addr == LLDB_INVALID_ADDRESS ||
+               second.GetLoadAddress() != base_addr + elem_type.GetByteSize()) {
+                return false;
+            }
+        } else {
+            return false;
+        }
+
+        auto format = ScalarFormat::ForType(elem_type);
+
+        // Pointers need their `SBValue`s for LLDB's summaries (e.g. the contents of a
+        // `const char*`) and to be expanded to what they point to
+        if(!format || format->kind == ScalarFormat::Pointer || base_addr == LLDB_INVALID_ADDRESS) {
+            return false;
+        }
+
+        size_t count = end - node.page_start;
+
+        std::vector<uint8_t> bytes(count * format->size);
+
+        auto read = memory_cache.Read(
+            base_addr + static_cast<lldb::addr_t>(node.page_start) * format->size,
+            bytes.data(),
+            bytes.size()
+        );
+
+        if(read != bytes.size()) {
+            return false;
+        }
+
+        auto* elem_type_name = elem_type.GetDisplayTypeName();
+
+        node.children.reserve(count);
+
+        for(size_t i = 0; i < count; ++i) {
+            Node child;
+
+            child.name = std::format("[{}]", node.page_start + i);
+            child.path = node.path + '/' + child.name;
+            child.type_name = elem_type_name ? elem_type_name : "";
+
+            child.addr = base_addr + static_cast<lldb::addr_t>(node.page_start + i) * format->size;
+            child.byte_size = format->size;
+
+            format->Format(bytes.data() + i * format->size, child.value_str);
+
+            node.children.push_back(std::move(child));
+        }
+
+        return true;
+    }
+
+    VariableTree::Node VariableTree::MakeNode(
+        lldb::SBValue value,
+        const std::string& parent_path,
+        MemoryPageCache& memory_cache,
+        ValueFormatters& formatters
+    ) {
+        Node node;
+
+        auto* name = value.GetName();
+        node.name = name ? name : "";
+
+        node.path = parent_path.empty() ? node.name : parent_path + '/' + node.name;
+
+        auto* type_name = value.GetDisplayTypeName();
+        node.type_name = type_name ? type_name : "";
+
+        if(auto formatted = formatters.Format(value, memory_cache)) {
+            node.value_str = std::move(*formatted);
+        } else {
+            const char* value_str = value.GetValue();
+
+            if(!value_str) {
+                value_str = value.GetSummary();
+            }
+
+            node.value_str = value_str ? value_str : "";
+        }
+
+        node.might_have_children = value.MightHaveChildren();
+        node.value = std::move(value);
+
+        return node;
+    }
+}
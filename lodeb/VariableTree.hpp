@@ -0,0 +1,162 @@
+#pragma once
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "StopKey.hpp"
+#include "ValueFormatters.hpp"
+#include "ValueSnapshot.hpp"
+
+namespace lodeb {
+    // The locals of a frame as a tree that's expanded lazily: children are only
+    // fetched (through `SBValue::GetChildAtIndex`) when a node is first expanded,
+    // and are kept until the stop or selected frame changes.
+    //
+    // We remember which nodes are expanded by their path of names, so after the
+    // next stop the same variables are expanded again (and only those have their
+    // children fetched).
+    //
+    // Nodes with lots of children (e.g. a huge `std::vector`) only have one page
+    // of them fetched at a time. Pages of scalars in contiguous memory come from
+    // a single memory read rather than an `SBValue` per element.
+    //
+    // Fetching the variables for a new stop (along with the children of whatever
+    // is expanded) happens on a worker. Until it's done the tree from the previous
+    // stop is kept around, marked stale.
+    class VariableTree {
+    public:
+        static constexpr uint32_t PAGE_SIZE = 1000;
+
+        struct Node {
+            std::string name;
+
+            // Names from the root joined by '/'
+            std::string path;
+
+            lldb::SBValue value;
+
+            // Elements read straight from memory by `ReadScalarChildren` have no `value`,
+            // this is where they are instead (so they can still be watched)
+            lldb::addr_t addr = LLDB_INVALID_ADDRESS;
+            size_t byte_size = 0;
+
+            std::string type_name;
+
+            // Scalars have a value, things like strings and containers have a summary,
+            // aggregates have neither so this is empty.
+            std::string value_str;
+
+            bool might_have_children = false;
+
+            // Compared against the previous stop the first time it's asked for
+            std::optional<bool> changed;
+
+            bool children_fetched = false;
+
+            // `children` only holds [page_start, page_start + PAGE_SIZE)
+            uint32_t num_children = 0;
+            uint32_t page_start = 0;
+
+            std::vector<Node> children;
+        };
+
+        // Starts fetching the variables if we're at a different stop/frame than last time.
+        // Memory is read through `memory_cache` and values are formatted with `formatters`
+        // where possible, both of which have to outlive this.
+        void Sync(lldb::SBProcess& process, lldb::SBFrame& frame, MemoryPageCache& memory_cache, ValueFormatters& formatters);
+
+        // Picks up the result of the fetch, if it's done
+        void Update();
+
+        // Abandons the fetch in progress (e.g. because we're about to step again)
+        void Cancel();
+
+        // Whether `Roots` are from an earlier stop/frame than the one we're fetching for
+        bool IsStale() const { return pending.has_value(); }
+
+        std::vector<Node>& Roots() { return roots; }
+
+        // Fetches the children of `node` the first time it's called on it. Don't
+        // call this on a stale tree.
+        std::vector<Node>& Children(Node& node);
+
+        // Whether the value is different from what it was at the previous stop. Only
+        // call this for nodes that are actually displayed, since it reads their memory.
+        bool Changed(Node& node);
+
+        bool IsExpanded(const Node& node) const { return expanded_paths.contains(node.path); }
+        void SetExpanded(const Node& node, bool expanded);
+
+        // Switches to the page containing `index`, fetching it next time `Children` is called
+        void SetPage(Node& node, uint32_t index);
+
+    private:
+        struct FetchResult {
+            StopKey key;
+            std::string func_name;
+            std::vector<Node> roots;
+        };
+
+        std::optional<StopKey> key;
+
+        MemoryPageCache* memory_cache = nullptr;
+        ValueFormatters* formatters = nullptr;
+
+        std::vector<Node> roots;
+
+        std::optional<std::future<FetchResult>> pending;
+        std::shared_ptr<std::atomic<bool>> pending_cancelled;
+
+        // Cancelled fetches which we still have to wait on, since a future's
+        // destructor blocks until it's done.
+        std::vector<std::future<FetchResult>> cancelled;
+
+        // Prepended to node paths in `snapshot` so we don't compare locals of
+        // different functions that happen to have the same name.
+        std::string snapshot_prefix;
+        ValueSnapshot snapshot;
+
+        // Paths of expanded nodes to the page they're on. Survives across stops.
+        using ExpandedPaths = std::unordered_map<std::string, uint32_t>;
+
+        ExpandedPaths expanded_paths;
+
+        static FetchResult Fetch(
+            lldb::SBFrame frame,
+            StopKey key,
+            ExpandedPaths expanded_paths,
+            MemoryPageCache* memory_cache,
+            ValueFormatters* formatters,
+            std::shared_ptr<std::atomic<bool>> cancelled
+        );
+
+        // Fetches the children of `node` and of any of its expanded descendants
+        static void FetchExpanded(
+            Node& node,
+            const ExpandedPaths& expanded_paths,
+            MemoryPageCache& memory_cache,
+            ValueFormatters& formatters,
+            const std::atomic<bool>& cancelled
+        );
+
+        static void FetchChildren(Node& node, MemoryPageCache& memory_cache, ValueFormatters& formatters);
+
+        // Returns false if the children aren't scalars laid out contiguously in memory
+        static bool ReadScalarChildren(Node& node, uint32_t end, MemoryPageCache& memory_cache);
+
+        static Node MakeNode(
+            lldb::SBValue value,
+            const std::string& parent_path,
+            MemoryPageCache& memory_cache,
+            ValueFormatters& formatters
+        );
+    };
+}
@@ -0,0 +1,137 @@
+#include "WatchEvaluator.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <format>
+
+#include "Log.hpp"
+
+namespace {
+    std::optional<double> AsNumber(lldb::SBValue& value) {
+        // These would parse but there's no point plotting them
+        if(value.GetType().IsPointerType()) {
+            return std::nullopt;
+        }
+
+        const char* str = value.GetValue();
+
+        if(!str) {
+            return std::nullopt;
+        }
+
+        if(strcmp(str, "true") == 0) {
+            return 1.0;
+        }
+
+        if(strcmp(str, "false") == 0) {
+            return 0.0;
+        }
+
+        // Rules out e.g. chars, which look like "97 'a'"
+        char* end = nullptr;
+        double number = strtod(str, &end);
+
+        if(end == str || *end != '\0') {
+            return std::nullopt;
+        }
+
+        return number;
+    }
+}
+
+namespace lodeb {
+    void WatchEvaluator::Start(
+        lldb::SBFrame frame,
+        uint32_t stop_id,
+        std::vector<Request> requests,
+        MemoryPageCache& memory_cache,
+        ValueFormatters& formatters
+    ) {
+        Cancel();
+
+        shared = std::make_shared<Shared>();
+
+        // HACK(Apaar): Evaluates on another thread, we rely on LLDB's API lock
+        pending = std::async(std::launch::async, Run, std::move(frame), stop_id, std::move(requests), &memory_cache, &formatters, shared);
+    }
+
+    void WatchEvaluator::Cancel() {
+        if(!pending) {
+            return;
+        }
+
+        shared->cancelled = true;
+
+        cancelled.push_back(std::move(*pending));
+
+        pending.reset();
+        shared.reset();
+    }
+
+    lldb::SBExpressionOptions WatchEvaluator::Options() {
+        lldb::SBExpressionOptions opts;
+
+        opts.SetTimeoutInMicroSeconds(std::chrono::duration_cast<std::chrono::microseconds>(TIMEOUT).count());
+        opts.SetUnwindOnError(true);
+        opts.SetIgnoreBreakpoints(true);
+
+        return opts;
+    }
+
+    void WatchEvaluator::Run(
+        lldb::SBFrame frame,
+        uint32_t stop_id,
+        std::vector<Request> requests,
+        MemoryPageCache* memory_cache,
+        ValueFormatters* formatters,
+        std::shared_ptr<Shared> shared
+    ) {
+        auto opts = Options();
+
+        lldb::SBStream stream;
+
+        for(auto& request : requests) {
+            if(shared->cancelled) {
+                return;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+
+            Result result = {
+                .index = request.index,
+                .stop_id = stop_id,
+                .expr = std::move(request.expr),
+            };
+
+            result.value = EvaluateWatchExpr(frame, result.expr.c_str(), request.kind, opts);
+
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            // LLDB just gives us an error when it interrupts the expression, so go by how long it took
+            result.timed_out = result.value.GetError().Fail() && elapsed >= TIMEOUT;
+
+            if(result.timed_out) {
+                LogInfo("Watch expression {} timed out", result.expr);
+
+                result.desc = "<timed out>";
+            } else if(auto formatted = formatters->Format(result.value, *memory_cache)) {
+                // Same shape as what `GetDescription` gives us
+                auto* type_name = result.value.GetDisplayTypeName();
+
+                result.desc = std::format("({}) {} = {}", type_name ? type_name : "", result.expr, *formatted);
+            } else {
+                stream.Clear();
+                result.value.GetDescription(stream);
+
+                result.desc = stream.GetData();
+
+                if(!result.value.GetError().Fail()) {
+                    result.number = AsNumber(result.value);
+                }
+            }
+
+            std::lock_guard lock{shared->mutex};
+            shared->results.push_back(std::move(result));
+        }
+    }
+}
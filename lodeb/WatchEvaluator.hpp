@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "ValueFormatters.hpp"
+#include "WatchExpr.hpp"
+
+namespace lodeb {
+    // Evaluates watch expressions on a worker so that one which calls into the
+    // inferior (and maybe never returns) can't hang the UI. Each expression
+    // gets `TIMEOUT` to run, and results are handed back one by one as they
+    // finish rather than all at the end.
+    //
+    // This doesn't make the UI stall-free: LLDB holds the target's API lock for
+    // the whole evaluation, so any SB call the UI makes in the meantime (reading
+    // locals, frames, stepping) waits for the expression to finish. That's at
+    // most `TIMEOUT` per expression, which is why it's kept short. Cancelling
+    // doesn't interrupt the expression that's running either.
+    class WatchEvaluator {
+    public:
+        static constexpr auto TIMEOUT = std::chrono::milliseconds(100);
+
+        struct Request {
+            // Into `WatchState::expr_values`
+            size_t index = 0;
+
+            std::string expr;
+            WatchExprKind kind = WatchExprKind::Expression;
+        };
+
+        struct Result {
+            size_t index = 0;
+            uint32_t stop_id = 0;
+
+            // So we can tell if the watch was edited while we were evaluating it
+            std::string expr;
+
+            lldb::SBValue value;
+            std::string desc;
+
+            // If it's a scalar (not a pointer), for `ValueHistory`
+            std::optional<double> number;
+
+            bool timed_out = false;
+        };
+
+        // What every watch is evaluated with. Anything else that has to evaluate a
+        // watch-style expression on the UI thread should use these too.
+        static lldb::SBExpressionOptions Options();
+
+        // Abandons whatever is being evaluated and starts on `requests`, in order.
+        // `memory_cache` and `formatters` have to outlive this.
+        void Start(
+            lldb::SBFrame frame,
+            uint32_t stop_id,
+            std::vector<Request> requests,
+            MemoryPageCache& memory_cache,
+            ValueFormatters& formatters
+        );
+
+        // Abandons whatever is being evaluated. The expression that's already running
+        // still runs to completion (or times out), but its result is dropped.
+        void Cancel();
+
+        bool IsRunning() const { return pending.has_value(); }
+
+        // Passes every result that came in since the last call to `fn`
+        template <typename Fn>
+        void Drain(Fn&& fn) {
+            std::erase_if(cancelled, [](std::future<void>& eval) {
+                return eval.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+            });
+
+            if(!shared) {
+                return;
+            }
+
+            std::vector<Result> results;
+
+            {
+                std::lock_guard lock{shared->mutex};
+                results = std::move(shared->results);
+                shared->results.clear();
+            }
+
+            for(auto& result : results) {
+                fn(result);
+            }
+
+            if(pending && pending->wait_for(std::chrono::seconds::zero()) == std::future_status::ready) {
+                pending.reset();
+            }
+        }
+
+    private:
+        // Owned jointly with the worker so that it can outlive us being restarted
+        struct Shared {
+            std::mutex mutex;
+            std::vector<Result> results;
+
+            std::atomic<bool> cancelled = false;
+        };
+
+        std::shared_ptr<Shared> shared;
+
+        std::optional<std::future<void>> pending;
+
+        // Cancelled evaluations which we still have to wait on, since a future's
+        // destructor blocks until it's done.
+        std::vector<std::future<void>> cancelled;
+
+        static void Run(
+            lldb::SBFrame frame,
+            uint32_t stop_id,
+            std::vector<Request> requests,
+            MemoryPageCache* memory_cache,
+            ValueFormatters* formatters,
+            std::shared_ptr<Shared> shared
+        );
+    };
+}
@@ -0,0 +1,114 @@
+#include "WatchExpr.hpp"
+
+#include <cctype>
+
+namespace {
+    bool IsIdentStart(char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool IsIdentChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+    bool ConsumeIdent(std::string_view& s) {
+        if(s.empty() || !IsIdentStart(s.front())) {
+            return false;
+        }
+
+        size_t len = 1;
+
+        while(len < s.size() && IsIdentChar(s[len])) {
+            len += 1;
+        }
+
+        s.remove_prefix(len);
+        return true;
+    }
+
+    std::string_view Trim(std::string_view s) {
+        while(!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) {
+            s.remove_prefix(1);
+        }
+
+        while(!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) {
+            s.remove_suffix(1);
+        }
+
+        return s;
+    }
+}
+
+namespace lodeb {
+    WatchExprKind ClassifyWatchExpr(std::string_view expr) {
+        expr = Trim(expr);
+
+        bool has_prefix = !expr.empty() && (expr.front() == '*' || expr.front() == '&');
+
+        if(has_prefix) {
+            expr.remove_prefix(1);
+        }
+
+        if(!ConsumeIdent(expr)) {
+            return WatchExprKind::Expression;
+        }
+
+        if(expr.empty()) {
+            return has_prefix ? WatchExprKind::VariablePath : WatchExprKind::Variable;
+        }
+
+        while(!expr.empty()) {
+            if(expr.front() == '.') {
+                expr.remove_prefix(1);
+            } else if(expr.starts_with("->")) {
+                expr.remove_prefix(2);
+            } else if(expr.front() == '[') {
+                // Only constant subscripts, anything else needs evaluating
+                size_t close = 1;
+
+                while(close < expr.size() && std::isdigit(static_cast<unsigned char>(expr[close]))) {
+                    close += 1;
+                }
+
+                if(close == 1 || close >= expr.size() || expr[close] != ']') {
+                    return WatchExprKind::Expression;
+                }
+
+                expr.remove_prefix(close + 1);
+                continue;
+            } else {
+                return WatchExprKind::Expression;
+            }
+
+            if(!ConsumeIdent(expr)) {
+                return WatchExprKind::Expression;
+            }
+        }
+
+        return WatchExprKind::VariablePath;
+    }
+
+    lldb::SBValue EvaluateWatchExpr(lldb::SBFrame& frame, const char* expr, WatchExprKind kind, const lldb::SBExpressionOptions& opts) {
+        lldb::SBValue value;
+
+        switch(kind) {
+            case WatchExprKind::Variable:
+                value = frame.FindVariable(expr);
+                break;
+
+            case WatchExprKind::VariablePath:
+                value = frame.GetValueForVariablePath(expr);
+                break;
+
+            case WatchExprKind::Expression:
+                break;
+        }
+
+        // e.g. a global, or a function call that happens to look like a name
+        if(!value.IsValid() || value.GetError().Fail()) {
+            value = frame.EvaluateExpression(expr, opts);
+        }
+
+        return value;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string_view>
+
+#include <lldb/API/LLDB.h>
+
+namespace lodeb {
+    // Most watches are plain paths to variables (e.g. `req->header.id` or `buf[3]`),
+    // which LLDB can resolve straight from the frame's variables. Only anything
+    // more complicated needs to go through the expression parser (and JIT), which
+    // is a lot slower.
+    enum class WatchExprKind {
+        // Just a name, e.g. `count`
+        Variable,
+
+        // Names with member accesses, subscripts, and an optional leading `*`/`&`
+        VariablePath,
+
+        Expression,
+    };
+
+    WatchExprKind ClassifyWatchExpr(std::string_view expr);
+
+    // Uses the fastest way of evaluating `expr` that `kind` allows, falling back
+    // to the expression parser (with `opts`) if that doesn't find anything.
+    lldb::SBValue EvaluateWatchExpr(lldb::SBFrame& frame, const char* expr, WatchExprKind kind, const lldb::SBExpressionOptions& opts);
+}
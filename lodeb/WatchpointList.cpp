@@ -0,0 +1,117 @@
+#include "WatchpointList.hpp"
+
+#include <algorithm>
+#include <format>
+
+#include "Log.hpp"
+
+namespace lodeb {
+    bool WatchpointList::Add(lldb::SBValue value, std::string expr, bool read, MemoryPageCache& memory_cache) {
+        if(!value.IsValid() || value.GetError().Fail()) {
+            auto* err = value.GetError().GetCString();
+            error = err ? err : "Invalid value";
+
+            return false;
+        }
+
+        lldb::SBError wp_error;
+        auto watchpoint = value.Watch(true, read, true, wp_error);
+
+        return Push(watchpoint, wp_error, Entry{
+            .expr = std::move(expr),
+            .read = read,
+            .format = ScalarFormat::ForType(value.GetType()),
+        }, memory_cache);
+    }
+
+    bool WatchpointList::AddAddress(lldb::SBTarget& target, lldb::addr_t addr, size_t size, bool read, MemoryPageCache& memory_cache) {
+        lldb::SBError wp_error;
+        auto watchpoint = target.WatchAddress(addr, size, read, true, wp_error);
+
+        return Push(watchpoint, wp_error, Entry{
+            .expr = std::format("{:#x}", addr),
+            .read = read,
+        }, memory_cache);
+    }
+
+    void WatchpointList::Remove(lldb::SBTarget& target, lldb::watch_id_t id) {
+        target.DeleteWatchpoint(id);
+
+        std::erase_if(entries, [&](Entry& entry) {
+            return entry.watchpoint.GetID() == id;
+        });
+    }
+
+    void WatchpointList::Update(uint32_t stop_id, MemoryPageCache& memory_cache) {
+        for(auto& entry : entries) {
+            auto value = ReadValue(entry, memory_cache);
+            auto hit_count = entry.watchpoint.GetHitCount();
+
+            if(hit_count != entry.hit_count) {
+                LogInfo("Watchpoint on {} hit: {} -> {}", entry.expr, entry.value, value);
+
+                entry.hit_count = hit_count;
+
+                entry.old_value = std::move(entry.value);
+                entry.new_value = value;
+                entry.last_hit_stop_id = stop_id;
+            }
+
+            entry.value = std::move(value);
+        }
+    }
+
+    bool WatchpointList::Push(lldb::SBWatchpoint watchpoint, lldb::SBError& wp_error, Entry entry, MemoryPageCache& memory_cache) {
+        if(wp_error.Fail() || !watchpoint.IsValid()) {
+            auto* err = wp_error.GetCString();
+            error = err ? err : "Failed to set watchpoint";
+
+            LogError("Failed to watch {}: {}", entry.expr, error);
+            return false;
+        }
+
+        error.clear();
+
+        // Watching the same memory again gives us back the same watchpoint
+        std::erase_if(entries, [&](Entry& existing) {
+            return existing.watchpoint.GetID() == watchpoint.GetID();
+        });
+
+        entry.watchpoint = watchpoint;
+        entry.hit_count = watchpoint.GetHitCount();
+
+        // The format only makes sense if it covers the whole thing
+        if(entry.format && entry.format->size != watchpoint.GetWatchSize()) {
+            entry.format.reset();
+        }
+
+        entry.value = ReadValue(entry, memory_cache);
+
+        entries.push_back(std::move(entry));
+
+        return true;
+    }
+
+    std::string WatchpointList::ReadValue(Entry& entry, MemoryPageCache& memory_cache) {
+        uint8_t bytes[16];
+
+        size_t size = std::min(entry.watchpoint.GetWatchSize(), sizeof(bytes));
+
+        if(memory_cache.Read(entry.watchpoint.GetWatchAddress(), bytes, size) != size) {
+            return "<unreadable>";
+        }
+
+        std::string value;
+
+        if(entry.format) {
+            entry.format->Format(bytes, value);
+            return value;
+        }
+
+        for(size_t i = 0; i < size; ++i) {
+            std::format_to(std::back_inserter(value), "{}{:02x}", i == 0 ? "" : " ", bytes[i]);
+        }
+
+        return value;
+    }
+}
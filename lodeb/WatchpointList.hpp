@@ -0,0 +1,69 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <lldb/API/LLDB.h>
+
+#include "MemoryPageCache.hpp"
+#include "ScalarFormat.hpp"
+
+namespace lodeb {
+    // Hardware watchpoints we've set, along with what the watched memory was
+    // before and after the last time each one was hit.
+    //
+    // The value is re-read at every stop, so when a watchpoint is hit the "old"
+    // value is whatever it was at the stop before.
+    class WatchpointList {
+    public:
+        struct Entry {
+            lldb::SBWatchpoint watchpoint;
+
+            // What it was set from, e.g. "foo.bar[3]" or an address
+            std::string expr;
+
+            bool read = false;
+
+            // Empty if it's not a scalar, in which case values are shown as hex
+            std::optional<ScalarFormat> format;
+
+            uint32_t hit_count = 0;
+
+            // As of the last stop
+            std::string value;
+
+            // Before and after the last hit, empty if it hasn't been hit yet
+            std::string old_value;
+            std::string new_value;
+            uint32_t last_hit_stop_id = 0;
+        };
+
+        // Watches the memory `value` lives in for writes (and reads, if `read`).
+        // Returns false and sets `error` if that isn't possible, e.g. because we're
+        // out of debug registers.
+        bool Add(lldb::SBValue value, std::string expr, bool read, MemoryPageCache& memory_cache);
+
+        // Same as above but for raw memory
+        bool AddAddress(lldb::SBTarget& target, lldb::addr_t addr, size_t size, bool read, MemoryPageCache& memory_cache);
+
+        void Remove(lldb::SBTarget& target, lldb::watch_id_t id);
+
+        // Call at every stop. Picks up new hits and re-reads the watched values.
+        void Update(uint32_t stop_id, MemoryPageCache& memory_cache);
+
+        std::vector<Entry>& Entries() { return entries; }
+
+        // From the last `Add`/`AddAddress` which failed, cleared when one succeeds
+        const std::string& Error() const { return error; }
+
+    private:
+        std::vector<Entry> entries;
+
+        std::string error;
+
+        bool Push(lldb::SBWatchpoint watchpoint, lldb::SBError& wp_error, Entry entry, MemoryPageCache& memory_cache);
+
+        static std::string ReadValue(Entry& entry, MemoryPageCache& memory_cache);
+    };
+}
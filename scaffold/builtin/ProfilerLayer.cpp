@@ -46,6 +46,7 @@ void ProfilerLayer::OnRenderUI(float deltaTime)
 
 	ImGui::Text("Frame timing: %.2f FPS (%.4fms)", 1.0f / deltaTime, deltaTime * 1000.0f);
 	ImGui::Text("1 sec window: %i FPS (%.4fms)", lastFrameCount, lastFrameTime * 1000.0f);
+	ImGui::Text("Allocations: %zu last frame", Scaffold::Application::GetProfiler().GetFrameAllocationCount());
 
 	ImGui::SeparatorText("MARKERS");
 
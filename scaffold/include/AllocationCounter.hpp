@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Scaffold
+{
+	// Total number of calls to the global operator new since startup, across all threads.
+	size_t GetTotalAllocationCount();
+} // namespace Scaffold
@@ -19,10 +19,16 @@ namespace Scaffold
 		Marker& GetRootMarker();
 		std::string GenerateReport();
 
+		// Heap allocations made during the last finished frame (all threads)
+		size_t GetFrameAllocationCount();
+
 	private:
 		Marker m_finishedRoot;
 		Marker m_activeRoot;
 
+		size_t m_frameStartAllocationCount = 0;
+		size_t m_lastFrameAllocationCount = 0;
+
 		Marker* m_activeMarker;
 		Marker* m_activeLoopMarker;
 	};
@@ -0,0 +1,58 @@
+#include <AllocationCounter.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replacing the global allocation functions lets the profiler report how many
+// heap allocations happen per frame. Only the plain (non-aligned) forms are
+// replaced; the aligned ones fall back to the standard library.
+
+static std::atomic<size_t> s_allocationCount = 0;
+
+static void* CountedAlloc(size_t size)
+{
+	s_allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	if (size == 0) size = 1;
+
+	return std::malloc(size);
+}
+
+size_t Scaffold::GetTotalAllocationCount()
+{
+	return s_allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+	void* ptr = CountedAlloc(size);
+	if (!ptr) throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	void* ptr = CountedAlloc(size);
+	if (!ptr) throw std::bad_alloc();
+
+	return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAlloc(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
@@ -1,4 +1,5 @@
 #include <Profiler.hpp>
+#include <AllocationCounter.hpp>
 
 #include <iostream>
 #include <sstream>
@@ -9,6 +10,8 @@ using namespace Scaffold;
 
 void Profiler::BeginFrame()
 {
+	m_frameStartAllocationCount = GetTotalAllocationCount();
+
 	m_activeRoot = Marker("Frame");
 	m_activeMarker = &m_activeRoot;
 }
@@ -18,6 +21,8 @@ void Profiler::EndFrame()
 	EndMarker();
 	m_finishedRoot = std::move(m_activeRoot);
 
+	m_lastFrameAllocationCount = GetTotalAllocationCount() - m_frameStartAllocationCount;
+
 	for (auto&& marker : m_finishedRoot.subMarkers)
 	{
 		marker.get()->parentMarker = &m_finishedRoot;
@@ -42,6 +47,11 @@ Marker& Profiler::GetRootMarker()
 	return m_finishedRoot;
 }
 
+size_t Profiler::GetFrameAllocationCount()
+{
+	return m_lastFrameAllocationCount;
+}
+
 std::string Profiler::GenerateReport()
 {
 	Marker& rootMarker = GetRootMarker();